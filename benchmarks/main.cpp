@@ -41,6 +41,20 @@ void run_lu_benchmark() {
     auto end = high_resolution_clock::now();
     
     std::cout << "LU Decomposition (" << N << "x" << N << "): " 
+              << duration_cast<milliseconds>(end - start).count() << " ms\n";
+
+    // Dense random matrix with partial pivoting
+    int M = 2000;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    tensor R({static_cast<size_t>(M), static_cast<size_t>(M)});
+    for (size_t i = 0; i < R.total_size(); ++i) R.raw()[i] = dist(gen);
+
+    start = high_resolution_clock::now();
+    linear_algebra::lu_factorization<double> F(R);
+    end = high_resolution_clock::now();
+
+    std::cout << "LU Factorization, partial pivoting (" << M << "x" << M << "): " 
               << duration_cast<milliseconds>(end - start).count() << " ms\n\n";
 }
 
@@ -161,6 +175,67 @@ void run_graph_benchmark() {
               << duration_cast<milliseconds>(end - start).count() << " ms\n\n";
 }
 
+void run_sparse_benchmark() {
+    std::cout << "--- Sparse CG Benchmark ---\n";
+    // 2D Poisson problem on a 500x500 grid (250k unknowns, ~1.25M nonzeros)
+    size_t m = 500, n = m * m;
+    std::vector<std::tuple<size_t, size_t, double>> triplets;
+    triplets.reserve(5 * n);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            size_t r = i * m + j;
+            triplets.push_back({r, r, 4.0});
+            if (i > 0) triplets.push_back({r, r - m, -1.0});
+            if (i + 1 < m) triplets.push_back({r, r + m, -1.0});
+            if (j > 0) triplets.push_back({r, r - 1, -1.0});
+            if (j + 1 < m) triplets.push_back({r, r + 1, -1.0});
+        }
+    }
+    auto A = sparse_matrix<double>::from_triplets(n, n, triplets);
+    numc::vector<double> b(n);
+    for (size_t i = 0; i < n; ++i) b[i] = 1.0;
+
+    auto start = high_resolution_clock::now();
+    numc::vector<double> y;
+    for (int i = 0; i < 100; ++i) A.multiply(b, y);
+    auto mid = high_resolution_clock::now();
+    auto x = A.solve_cg(b, 1e-6, 500);
+    auto end = high_resolution_clock::now();
+
+    std::cout << "SpMV x100 (" << A.nnz() << " nnz, " << utility::num_threads() << " threads): "
+              << duration_cast<milliseconds>(mid - start).count() << " ms\n";
+    std::cout << "Conjugate Gradient (500 iterations max): "
+              << duration_cast<milliseconds>(end - mid).count() << " ms\n";
+
+    sell_matrix<double> S(A);
+    start = high_resolution_clock::now();
+    for (int i = 0; i < 100; ++i) S.multiply(b, y);
+    end = high_resolution_clock::now();
+    std::cout << "SELL-8-256 SpMV x100 (fill ratio " << S.fill_ratio() << "): "
+              << duration_cast<milliseconds>(end - start).count() << " ms\n";
+
+    // 3x3 block version of the same stencil, as produced by vector-valued (elasticity-like) problems
+    sparse_builder<double> builder(3 * n, 3 * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = A.row_ptr()[i]; k < A.row_ptr()[i + 1]; ++k) {
+            for (size_t r = 0; r < 3; ++r) {
+                for (size_t c = 0; c < 3; ++c) builder.add(3 * i + r, 3 * A.col_indices()[k] + c, A.values()[k] * (r == c ? 1.0 : 0.1));
+            }
+        }
+    }
+    auto A3 = builder.build();
+    bsr_matrix<double> B3(A3, 3);
+    numc::vector<double> b3(3 * n), y3;
+    for (size_t i = 0; i < 3 * n; ++i) b3[i] = 1.0;
+    start = high_resolution_clock::now();
+    for (int i = 0; i < 100; ++i) A3.multiply(b3, y3);
+    mid = high_resolution_clock::now();
+    for (int i = 0; i < 100; ++i) B3.multiply(b3, y3);
+    end = high_resolution_clock::now();
+    std::cout << "3x3 blocks, CSR SpMV x100: " << duration_cast<milliseconds>(mid - start).count() << " ms, BSR SpMV x100: "
+              << duration_cast<milliseconds>(end - mid).count() << " ms\n\n";
+}
+
 int main() {
     std::cout << "==========================================\n";
     std::cout << "           NumC Benchmarks Suite          \n";
@@ -174,6 +249,7 @@ int main() {
     run_kmeans_benchmark();
     run_primes_benchmark();
     run_graph_benchmark();
+    run_sparse_benchmark();
     
     std::cout << "Benchmarks finished.\n";
     return 0;
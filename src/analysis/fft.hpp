@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include "../common/complex.hpp"
 #include "../common/vector.hpp"
 #include "../common/function.hpp"
@@ -47,65 +51,492 @@ vector<T> idft(const std::vector<complex<T>>& X) {
   return x;
 }
 
-/// @brief In-place Cooley-Tukey radix-2 FFT.
+namespace detail {
+
+/// @brief Process-wide registry of immutable FFT plans of one kind, keyed by size.
+template <typename Plan>
+class plan_cache {
+ private:
+  struct _registry {
+    std::mutex mutex;
+    std::unordered_map<size_t, std::shared_ptr<const Plan>> plans;
+  };
+
+  static _registry& _instance() {
+    static _registry r;
+    return r;
+  }
+
+ public:
+  /// @brief The plan of size n; concurrent first requests may both build it, but only one is kept.
+  static std::shared_ptr<const Plan> get(size_t n) {
+    _registry& r = _instance();
+    {
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto it = r.plans.find(n);
+      if (it != r.plans.end()) return it->second;
+    }
+    auto plan = std::make_shared<const Plan>(n);
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.plans.try_emplace(n, std::move(plan)).first->second;
+  }
+
+  static void clear() {
+    _registry& r = _instance();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.plans.clear();
+  }
+};
+
+}  // namespace detail
+
+/// @brief Smallest n' >= n whose only prime factors are 2, 3, 5 and 7, i.e. a length that the mixed-radix
+/// FFT handles with its specialized butterflies. Useful for choosing a zero-padding length.
+inline size_t next_fast_len(size_t n) {
+  for (size_t m = std::max<size_t>(n, 1);; ++m) {
+    size_t r = m;
+    for (size_t p : {2, 3, 5, 7})
+      while (r % p == 0) r /= p;
+    if (r == 1) return m;
+  }
+}
+
+/// @brief Precomputed FFT of one length n, for any n >= 1; the algorithm is chosen from the factorization of n:
+/// - powers of two: iterative radix-2 Cooley-Tukey, with the bit-reversal permutation kept as a list of
+///   transpositions and the twiddles of every stage stored contiguously;
+/// - lengths whose prime factors are all at most 64: recursive mixed-radix Cooley-Tukey (decimation in time)
+///   with butterflies for radix 4, 2, 3, 5 and 7 and a generic odd-prime butterfly for the rest;
+/// - anything else (large prime factors): Bluestein's chirp-z algorithm, which turns the transform into a
+///   circular convolution computed with a power-of-two plan of length >= 2n - 1.
+/// Every twiddle is evaluated directly with cos/sin, so there is no drift at large n. A plan is immutable
+/// after construction and may be shared between threads; cached() returns the plan of a size from a
+/// process-wide registry, building it on first use.
+template <typename T = double>
+class fft_plan {
+ private:
+  enum class _algorithm { radix2, mixed_radix, bluestein };
+
+  static constexpr size_t _max_radix = 64;  // larger prime factors go to Bluestein
+
+  size_t _n;
+  _algorithm _alg;
+  std::vector<std::pair<size_t, size_t>> _swaps;  // radix-2: bit-reversal transpositions (i, rev(i)), i < rev(i)
+  std::vector<complex<T>> _stage_tw;              // radix-2: stage of half-length h at [h, 2h): exp(-2 pi i j / (2h))
+  std::vector<std::pair<size_t, size_t>> _factors;  // mixed radix: (radix p, remaining length m), outermost first
+  std::vector<complex<T>> _tw;                      // mixed radix: exp(-2 pi i k / n), k < n
+  std::vector<complex<T>> _chirp;                   // Bluestein: exp(-i pi k^2 / n), k < n
+  std::vector<complex<T>> _filter;                  // Bluestein: transform of the conjugate chirp, wrapped
+  std::shared_ptr<const fft_plan> _inner;           // Bluestein: power-of-two convolution plan
+
+  void _check(size_t n) const {
+    if (n != _n) {
+      Log::Error("FFT plan of size " + std::to_string(_n) + " applied to " + std::to_string(n) + " points.");
+      throw std::invalid_argument("Signal length does not match the FFT plan.");
+    }
+  }
+
+  void _radix2(complex<T>* x, bool inverse) const {
+    for (const auto& [i, j] : _swaps) std::swap(x[i], x[j]);
+    T sign = inverse ? T(-1.0) : T(1.0);
+    for (size_t h = 1; h < _n; h <<= 1) {
+      const complex<T>* w = _stage_tw.data() + h;
+      for (size_t i = 0; i < _n; i += 2 * h) {
+        complex<T>* a = x + i;
+        complex<T>* b = a + h;
+        for (size_t j = 0; j < h; ++j) {
+          T wr = w[j].real(), wi = sign * w[j].imag();
+          T br = b[j].real(), bi = b[j].imag();
+          T vr = br * wr - bi * wi, vi = br * wi + bi * wr;
+          T ar = a[j].real(), ai = a[j].imag();
+          a[j] = complex<T>(ar + vr, ai + vi);
+          b[j] = complex<T>(ar - vr, ai - vi);
+        }
+      }
+    }
+  }
+
+  // Mixed-radix butterflies combine p transforms of length m stored consecutively at out into one of length
+  // p m; input q of output u is first multiplied by the twiddle _tw[q u fstride].
+  void _butterfly2(complex<T>* out, size_t fstride, size_t m) const {
+    for (size_t u = 0; u < m; ++u) {
+      complex<T> t = out[u + m] * _tw[u * fstride];
+      out[u + m] = out[u] - t;
+      out[u] = out[u] + t;
+    }
+  }
+
+  void _butterfly4(complex<T>* out, size_t fstride, size_t m) const {
+    for (size_t u = 0; u < m; ++u) {
+      complex<T> a0 = out[u];
+      complex<T> a1 = out[u + m] * _tw[u * fstride];
+      complex<T> a2 = out[u + 2 * m] * _tw[2 * u * fstride];
+      complex<T> a3 = out[u + 3 * m] * _tw[3 * u * fstride];
+      complex<T> s02 = a0 + a2, d02 = a0 - a2, s13 = a1 + a3, d13 = a1 - a3;
+      out[u] = s02 + s13;
+      out[u + 2 * m] = s02 - s13;
+      out[u + m] = complex<T>(d02.real() + d13.imag(), d02.imag() - d13.real());      // d02 - i d13
+      out[u + 3 * m] = complex<T>(d02.real() - d13.imag(), d02.imag() + d13.real());  // d02 + i d13
+    }
+  }
+
+  // Odd radix p (P = p for the unrolled 3, 5, 7; P = 0 for a generic prime): with s_q = a_q + a_(p-q) and
+  // d_q = a_q - a_(p-q), output k is a_0 + sum_q (s_q cos + i d_q sin)(2 pi q k / p), so the pairs k, p - k
+  // share all products and the cost is about p^2 / 2 real multiply-adds per p points instead of p^2 complex.
+  template <size_t P>
+  void _butterfly_odd(complex<T>* out, size_t fstride, size_t m, size_t p) const {
+    if constexpr (P != 0) p = P;
+    size_t half = (p - 1) / 2, step = _n / p;
+    std::conditional_t<P != 0, std::array<complex<T>, P>, std::vector<complex<T>>> a{};
+    std::conditional_t<P != 0, std::array<complex<T>, P>, std::vector<complex<T>>> sd{};
+    if constexpr (P == 0) {
+      a.resize(p);
+      sd.resize(p);
+    }
+    for (size_t u = 0; u < m; ++u) {
+      a[0] = out[u];
+      for (size_t q = 1; q < p; ++q) a[q] = out[u + q * m] * _tw[q * u * fstride];
+      T sum_r = a[0].real(), sum_i = a[0].imag();
+      for (size_t q = 1; q <= half; ++q) {
+        sd[q] = a[q] + a[p - q];
+        sd[p - q] = a[q] - a[p - q];
+        sum_r += sd[q].real();
+        sum_i += sd[q].imag();
+      }
+      for (size_t k = 1; k <= half; ++k) {
+        T rr = a[0].real(), ri = a[0].imag(), ir = T(0.0), ii = T(0.0);
+        for (size_t q = 1; q <= half; ++q) {
+          const complex<T>& w = _tw[((q * k) % p) * step];  // cos - i sin of 2 pi q k / p
+          rr += sd[q].real() * w.real();
+          ri += sd[q].imag() * w.real();
+          ir += sd[p - q].real() * w.imag();
+          ii += sd[p - q].imag() * w.imag();
+        }
+        out[u + k * m] = complex<T>(rr - ii, ri + ir);
+        out[u + (p - k) * m] = complex<T>(rr + ii, ri - ir);
+      }
+      out[u] = complex<T>(sum_r, sum_i);
+    }
+  }
+
+  void _mixed(complex<T>* out, const complex<T>* in, size_t fstride, size_t level) const {
+    auto [p, m] = _factors[level];
+    if (m == 1) {
+      for (size_t q = 0; q < p; ++q) out[q] = in[q * fstride];
+    } else {
+      for (size_t q = 0; q < p; ++q) _mixed(out + q * m, in + q * fstride, fstride * p, level + 1);
+    }
+    switch (p) {
+      case 2: _butterfly2(out, fstride, m); break;
+      case 4: _butterfly4(out, fstride, m); break;
+      case 3: _butterfly_odd<3>(out, fstride, m, p); break;
+      case 5: _butterfly_odd<5>(out, fstride, m, p); break;
+      case 7: _butterfly_odd<7>(out, fstride, m, p); break;
+      default: _butterfly_odd<0>(out, fstride, m, p); break;
+    }
+  }
+
+  void _bluestein(complex<T>* x) const {
+    std::vector<complex<T>> a(_inner->size());
+    for (size_t k = 0; k < _n; ++k) a[k] = x[k] * _chirp[k];
+    _inner->forward(a.data());
+    for (size_t k = 0; k < a.size(); ++k) a[k] = a[k] * _filter[k];
+    _inner->inverse(a.data());
+    for (size_t k = 0; k < _n; ++k) x[k] = a[k] * _chirp[k];
+  }
+
+  void _execute(complex<T>* x, bool inverse) const {
+    if (_alg == _algorithm::radix2) {
+      _radix2(x, inverse);
+      return;
+    }
+    // The inverse is the forward transform of the conjugate, conjugated.
+    if (inverse)
+      for (size_t i = 0; i < _n; ++i) x[i] = x[i].conjugate();
+    if (_alg == _algorithm::mixed_radix) {
+      std::vector<complex<T>> in(x, x + _n);
+      _mixed(x, in.data(), 1, 0);
+    } else {
+      _bluestein(x);
+    }
+    if (inverse)
+      for (size_t i = 0; i < _n; ++i) x[i] = x[i].conjugate();
+  }
+
+  static complex<T> _unit(T angle) { return complex<T>(std::cos(angle), std::sin(angle)); }
+
+ public:
+  /// @throws std::invalid_argument If n is zero.
+  explicit fft_plan(size_t n) : _n(n) {
+    if (n == 0) {
+      Log::Error("FFT plan size must be positive.");
+      throw std::invalid_argument("FFT size must be positive.");
+    }
+    const T two_pi = T(2.0) * T(numc::PI);
+
+    if ((n & (n - 1)) == 0) {
+      _alg = _algorithm::radix2;
+      size_t bits = 0;
+      while ((size_t(1) << bits) < n) ++bits;
+      std::vector<size_t> rev(n, 0);
+      for (size_t i = 1; i < n; ++i) {
+        rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (bits - 1));
+        if (i < rev[i]) _swaps.emplace_back(i, rev[i]);
+      }
+      _stage_tw.resize(n);
+      size_t half = n / 2;
+      for (size_t j = 0; j < half; ++j) _stage_tw[half + j] = _unit(-two_pi * T(j) / T(n));
+      for (size_t h = half / 2; h >= 1; h /= 2) {
+        size_t stride = half / h;
+        for (size_t j = 0; j < h; ++j) _stage_tw[h + j] = _stage_tw[half + j * stride];
+      }
+      return;
+    }
+
+    std::vector<size_t> radices;
+    size_t r = n;
+    while (r % 4 == 0) {
+      radices.push_back(4);
+      r /= 4;
+    }
+    if (r % 2 == 0) {
+      radices.push_back(2);
+      r /= 2;
+    }
+    for (size_t p = 3; p * p <= r; p += 2)
+      while (r % p == 0) {
+        radices.push_back(p);
+        r /= p;
+      }
+    if (r > 1) radices.push_back(r);
+
+    if (*std::max_element(radices.begin(), radices.end()) <= _max_radix) {
+      _alg = _algorithm::mixed_radix;
+      size_t m = n;
+      for (size_t p : radices) {
+        m /= p;
+        _factors.emplace_back(p, m);
+      }
+      _tw.resize(n);
+      for (size_t k = 0; k < n; ++k) _tw[k] = _unit(-two_pi * T(k) / T(n));
+      return;
+    }
+
+    _alg = _algorithm::bluestein;
+    size_t m = 1;
+    while (m < 2 * n - 1) m <<= 1;
+    _inner = cached(m);
+    _chirp.resize(n);
+    for (size_t k = 0; k < n; ++k) _chirp[k] = _unit(-T(numc::PI) * T((k * k) % (2 * n)) / T(n));
+    _filter.assign(m, complex<T>(T(0.0), T(0.0)));
+    _filter[0] = _chirp[0].conjugate();
+    for (size_t k = 1; k < n; ++k) _filter[k] = _filter[m - k] = _chirp[k].conjugate();
+    _inner->forward(_filter.data());
+  }
+
+  /// @brief Transform length.
+  size_t size() const { return _n; }
+
+  /// @brief In-place forward transform X_k = sum_n x_n exp(-2 pi i k n / N) of size() points at x.
+  void forward(complex<T>* x) const { _execute(x, false); }
+
+  /// @brief In-place inverse transform, including the 1 / N scaling.
+  void inverse(complex<T>* x) const {
+    _execute(x, true);
+    T scale = T(1.0) / T(_n);
+    for (size_t i = 0; i < _n; ++i) x[i] = complex<T>(x[i].real() * scale, x[i].imag() * scale);
+  }
+
+  /// @throws std::invalid_argument If x.size() != size().
+  void forward(std::vector<complex<T>>& x) const {
+    _check(x.size());
+    forward(x.data());
+  }
+
+  /// @throws std::invalid_argument If x.size() != size().
+  void inverse(std::vector<complex<T>>& x) const {
+    _check(x.size());
+    inverse(x.data());
+  }
+
+  /// @brief The shared plan of size n, built and registered on first request. Thread-safe.
+  /// @throws std::invalid_argument If n is zero.
+  static std::shared_ptr<const fft_plan> cached(size_t n) { return detail::plan_cache<fft_plan>::get(n); }
+
+  /// @brief Drops all registered plans (plans still held by callers stay valid).
+  static void clear_cache() { detail::plan_cache<fft_plan>::clear(); }
+};
+
+/// @brief In-place FFT of any length, using the cached plan of the signal length.
 template <typename T = double>
 void fft_inplace(std::vector<complex<T>>& X) {
-  size_t N = X.size();
-  if (N <= 1) return;
-
-  // Bit-reversal permutation
-  size_t j = 0;
-  for (size_t i = 1; i < N; ++i) {
-    size_t bit = N >> 1;
-    while (j & bit) { j ^= bit; bit >>= 1; }
-    j ^= bit;
-    if (i < j) std::swap(X[i], X[j]);
-  }
-
-  // Butterfly stages
-  for (size_t len = 2; len <= N; len <<= 1) {
-    T angle = -T(2.0) * T(numc::PI) / T(len);
-    complex<T> wlen(std::cos(angle), std::sin(angle));
-    for (size_t i = 0; i < N; i += len) {
-      complex<T> w(T(1.0), T(0.0));
-      for (size_t jj = 0; jj < len / 2; ++jj) {
-        complex<T> u = X[i + jj];
-        complex<T> v = w * X[i + jj + len / 2];
-        X[i + jj] = u + v;
-        X[i + jj + len / 2] = u - v;
-        w = w * wlen;
+  if (X.size() <= 1) return;
+  fft_plan<T>::cached(X.size())->forward(X.data());
+}
+
+/// @brief Precomputed FFT of a real signal of length n, returning the n / 2 + 1 non-redundant bins (the
+/// others follow from X_(n-k) = conj(X_k)). For even n the even and odd samples are packed as the real and
+/// imaginary parts of an n / 2 point complex signal, transformed with the cached fft_plan of that size, and
+/// separated again by a post-processing pass with the twiddles exp(-2 pi i k / n): half the work and memory
+/// of promoting the signal to complex. Odd n falls back to the full complex transform. Immutable and
+/// shareable between threads, like fft_plan.
+template <typename T = double>
+class rfft_plan {
+ private:
+  size_t _n;
+  std::shared_ptr<const fft_plan<T>> _half;  // even n: plan of size n / 2
+  std::shared_ptr<const fft_plan<T>> _full;  // odd n > 1: plan of size n
+  std::vector<complex<T>> _w;                // even n: exp(-2 pi i k / n), k < n / 2
+
+ public:
+  /// @throws std::invalid_argument If n is zero.
+  explicit rfft_plan(size_t n) : _n(n) {
+    if (n == 0) {
+      Log::Error("Real FFT plan size must be positive.");
+      throw std::invalid_argument("FFT size must be positive.");
+    }
+    if (n == 1) return;
+    if (n % 2 == 1) {
+      _full = fft_plan<T>::cached(n);
+      return;
+    }
+    size_t h = n / 2;
+    _half = fft_plan<T>::cached(h);
+    _w.resize(h);
+    for (size_t k = 0; k < h; ++k) {
+      T angle = -T(2.0) * T(numc::PI) * T(k) / T(n);
+      _w[k] = complex<T>(std::cos(angle), std::sin(angle));
+    }
+  }
+
+  /// @brief Length of the real signal.
+  size_t size() const { return _n; }
+
+  /// @brief Number of output bins, n / 2 + 1.
+  size_t bins() const { return _n / 2 + 1; }
+
+  /// @brief X_k = sum_j x_j exp(-2 pi i k j / n) for k = 0, ..., n / 2, from the n samples at x into the
+  /// bins() entries at X.
+  void forward(const T* x, complex<T>* X) const {
+    if (_n == 1) {
+      X[0] = complex<T>(x[0], T(0.0));
+      return;
+    }
+    if (_full) {
+      std::vector<complex<T>> z(x, x + _n);
+      _full->forward(z.data());
+      std::copy(z.begin(), z.begin() + bins(), X);
+      return;
+    }
+    size_t h = _n / 2;
+    for (size_t k = 0; k < h; ++k) X[k] = complex<T>(x[2 * k], x[2 * k + 1]);
+    _half->forward(X);
+    T z0r = X[0].real(), z0i = X[0].imag();
+    X[0] = complex<T>(z0r + z0i, T(0.0));
+    X[h] = complex<T>(z0r - z0i, T(0.0));
+    for (size_t k = 1; k <= h / 2; ++k) {
+      // E = (Z_k + conj Z_(h-k)) / 2 and O = -i (Z_k - conj Z_(h-k)) / 2 are the transforms of the even and
+      // odd samples; X_k = E + W^k O and X_(h-k) = conj(E - W^k O).
+      T ar = X[k].real(), ai = X[k].imag();
+      T br = X[h - k].real(), bi = X[h - k].imag();
+      T er = T(0.5) * (ar + br), ei = T(0.5) * (ai - bi);
+      T or_ = T(0.5) * (ai + bi), oi = T(0.5) * (br - ar);
+      T wr = _w[k].real(), wi = _w[k].imag();
+      T tr = wr * or_ - wi * oi, ti = wr * oi + wi * or_;
+      X[k] = complex<T>(er + tr, ei + ti);
+      X[h - k] = complex<T>(er - tr, ti - ei);
+    }
+  }
+
+  /// @brief Inverse of forward(), including the 1 / n scaling: the n real samples at x from the bins()
+  /// entries at X. The imaginary parts of X_0 and (for even n) X_(n/2) are ignored.
+  void inverse(const complex<T>* X, T* x) const {
+    if (_n == 1) {
+      x[0] = X[0].real();
+      return;
+    }
+    if (_full) {
+      std::vector<complex<T>> z(_n);
+      z[0] = complex<T>(X[0].real(), T(0.0));
+      for (size_t k = 1; k < bins(); ++k) {
+        z[k] = X[k];
+        z[_n - k] = X[k].conjugate();
       }
+      _full->inverse(z.data());
+      for (size_t k = 0; k < _n; ++k) x[k] = z[k].real();
+      return;
+    }
+    size_t h = _n / 2;
+    std::vector<complex<T>> z(h);
+    T x0 = X[0].real(), xh = X[h].real();
+    z[0] = complex<T>(T(0.5) * (x0 + xh), T(0.5) * (x0 - xh));
+    for (size_t k = 1; k <= h / 2; ++k) {
+      // E = (X_k + conj X_(h-k)) / 2, O = W^-k (X_k - conj X_(h-k)) / 2; Z_k = E + i O, Z_(h-k) = conj E + i conj O.
+      T ar = X[k].real(), ai = X[k].imag();
+      T br = X[h - k].real(), bi = X[h - k].imag();
+      T er = T(0.5) * (ar + br), ei = T(0.5) * (ai - bi);
+      T dr = T(0.5) * (ar - br), di = T(0.5) * (ai + bi);
+      T wr = _w[k].real(), wi = _w[k].imag();
+      T or_ = dr * wr + di * wi, oi = di * wr - dr * wi;
+      z[k] = complex<T>(er - oi, ei + or_);
+      z[h - k] = complex<T>(er + oi, or_ - ei);
+    }
+    _half->inverse(z.data());
+    for (size_t k = 0; k < h; ++k) {
+      x[2 * k] = z[k].real();
+      x[2 * k + 1] = z[k].imag();
     }
   }
+
+  /// @brief The shared plan of size n, built and registered on first request. Thread-safe.
+  /// @throws std::invalid_argument If n is zero.
+  static std::shared_ptr<const rfft_plan> cached(size_t n) { return detail::plan_cache<rfft_plan>::get(n); }
+
+  /// @brief Drops all registered plans (plans still held by callers stay valid).
+  static void clear_cache() { detail::plan_cache<rfft_plan>::clear(); }
+};
+
+/// @brief FFT of a real-valued signal of any length N, returning only the N / 2 + 1 non-redundant bins
+/// X_0, ..., X_(N/2).
+template <typename T = double>
+std::vector<complex<T>> rfft(const vector<T>& x) {
+  if (x.size() == 0) return {};
+  auto plan = rfft_plan<T>::cached(x.size());
+  std::vector<complex<T>> X(plan->bins());
+  plan->forward(x.raw(), X.data());
+  return X;
 }
 
-/// @brief Computes the FFT of a real-valued signal. Zero-pads to the next power of 2.
+/// @brief Inverse of rfft: the real signal of length n whose non-redundant bins are X. With n = 0 the length
+/// is taken as 2 (X.size() - 1) (1 for a single bin); pass n explicitly to recover an odd-length signal.
+/// @throws std::invalid_argument If X.size() != n / 2 + 1.
+template <typename T = double>
+vector<T> irfft(const std::vector<complex<T>>& X, size_t n = 0) {
+  if (n == 0) n = X.size() <= 1 ? X.size() : 2 * (X.size() - 1);
+  if (n == 0 || X.size() != n / 2 + 1) {
+    Log::Error("irfft: " + std::to_string(X.size()) + " bins do not describe a signal of length " + std::to_string(n) + ".");
+    throw std::invalid_argument("Number of bins does not match the signal length.");
+  }
+  vector<T> x(n);
+  rfft_plan<T>::cached(n)->inverse(X.data(), x.raw());
+  return x;
+}
+
+/// @brief Computes the FFT of a real-valued signal, returning exactly N = x.size() bins (no zero-padding).
+/// The non-redundant half is computed with rfft and the rest filled in by conjugate symmetry.
 template <typename T = double>
 std::vector<complex<T>> fft(const vector<T>& x) {
+  std::vector<complex<T>> X = rfft(x);
   size_t N = x.size();
-  // Find next power of 2
-  size_t M = 1;
-  while (M < N) M <<= 1;
-  std::vector<complex<T>> X(M);
-  for (size_t i = 0; i < N; ++i) X[i] = complex<T>(x[i], T(0.0));
-  for (size_t i = N; i < M; ++i) X[i] = complex<T>(T(0.0), T(0.0));
-  fft_inplace(X);
+  X.resize(N);
+  for (size_t k = N / 2 + 1; k < N; ++k) X[k] = X[N - k].conjugate();
   return X;
 }
 
-/// @brief In-place Inverse FFT.
+/// @brief In-place Inverse FFT of any length.
 template <typename T = double>
 void ifft_inplace(std::vector<complex<T>>& X) {
-  size_t N = X.size();
-  // Conjugate
-  for (size_t i = 0; i < N; ++i) {
-    X[i] = complex<T>(X[i].real(), -X[i].imag());
-  }
-  fft_inplace(X);
-  // Conjugate and scale
-  for (size_t i = 0; i < N; ++i) {
-    X[i] = complex<T>(X[i].real() / T(N), -X[i].imag() / T(N));
-  }
+  if (X.size() <= 1) return;
+  fft_plan<T>::cached(X.size())->inverse(X.data());
 }
 
 /// @brief Computes the IFFT and returns the real part as a vector.
@@ -118,14 +549,16 @@ vector<T> ifft(std::vector<complex<T>> X) {
 }
 
 /// @brief Computes the power spectral density |X(k)|^2 / N.
+/// Only the N / 2 + 1 non-redundant bins are transformed (rfft); the spectrum of real data is symmetric.
 template <typename T = double>
 vector<T> power_spectrum(const vector<T>& x) {
-  auto X = fft(x);
-  size_t N = X.size();
+  auto X = rfft(x);
+  size_t N = x.size();
   vector<T> P(N);
-  for (size_t k = 0; k < N; ++k) {
+  for (size_t k = 0; k < X.size(); ++k) {
     P[k] = (X[k].real() * X[k].real() + X[k].imag() * X[k].imag()) / T(N);
   }
+  for (size_t k = X.size(); k < N; ++k) P[k] = P[N - k];
   return P;
 }
 
@@ -143,26 +576,27 @@ vector<T> fft_freqs(size_t N, T fs = T(1.0)) {
 }
 
 /// @brief Convolves two real-valued signals using FFT.
+/// The signals are zero-padded to an even 2-3-5-7-smooth length M >= a.size() + b.size() - 1; both are real,
+/// so the transforms are half-length (rfft_plan) and the product has M / 2 + 1 bins.
 template <typename T = double>
 vector<T> convolve(const vector<T>& a, const vector<T>& b) {
   size_t outLen = a.size() + b.size() - 1;
-  size_t M = 1;
-  while (M < outLen) M <<= 1;
-
-  std::vector<complex<T>> A(M), B(M);
-  for (size_t i = 0; i < a.size(); ++i) A[i] = complex<T>(a[i], T(0.0));
-  for (size_t i = 0; i < b.size(); ++i) B[i] = complex<T>(b[i], T(0.0));
-
-  fft_inplace(A);
-  fft_inplace(B);
+  size_t M = 2 * next_fast_len((outLen + 1) / 2);  // even, so that the half-length packing applies
 
-  std::vector<complex<T>> C(M);
-  for (size_t i = 0; i < M; ++i) C[i] = A[i] * B[i];
+  auto plan = rfft_plan<T>::cached(M);
+  std::vector<T> buf(M, T(0.0));
+  std::vector<complex<T>> A(plan->bins()), B(plan->bins());
+  std::copy(a.begin(), a.end(), buf.begin());
+  plan->forward(buf.data(), A.data());
+  std::fill(buf.begin(), buf.end(), T(0.0));
+  std::copy(b.begin(), b.end(), buf.begin());
+  plan->forward(buf.data(), B.data());
 
-  ifft_inplace(C);
+  for (size_t i = 0; i < A.size(); ++i) A[i] = A[i] * B[i];
+  plan->inverse(A.data(), buf.data());
 
   vector<T> result(outLen);
-  for (size_t i = 0; i < outLen; ++i) result[i] = C[i].real();
+  for (size_t i = 0; i < outLen; ++i) result[i] = buf[i];
   return result;
 }
 
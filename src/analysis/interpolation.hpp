@@ -2,6 +2,7 @@
 
 #include "../common/vector.hpp"
 #include "../common/tensor.hpp"
+#include "../linear_algebra/tridiagonal.hpp"
 #include "../linear_algebra/solvers.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
@@ -91,9 +92,8 @@ vector<T> cubic_spline_curvatures(const vector<T>& xData, const vector<T>& yData
     k[i] = T(6.0) * (term1 - term2);
   }
 
-  auto [c_dec, d_dec, e_dec] = linear_algebra::lu_decomp3(c, d, e);
-  k = linear_algebra::lu_solve3(c_dec, d_dec, e_dec, k);
-  return k;
+  // Diagonally dominant for increasing knots, so Thomas without pivoting is stable.
+  return linear_algebra::tridiagonal_factorization<T>(c, d, e).solve(k);
 }
 
 /// @brief Evaluates the cubic spline at x.
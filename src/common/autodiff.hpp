@@ -162,6 +162,19 @@ T auto_diff(F f, T x) {
   return result.deriv();
 }
 
+/// @brief Computes the Jacobian-vector product J(x) v of F: R^n -> R^m exactly, with one evaluation of F at
+/// the dual point x + ε v. F must be generic over the element type, taking and returning a std::vector of it.
+/// Usage: jvp([](const auto& x) { return std::vector{x[0] * x[1], sin(x[0])}; }, x, v);
+template <typename F, typename T = double>
+vector<T> jvp(F F_func, const vector<T>& x, const vector<T>& v) {
+  std::vector<dual<T>> xd(x.size());
+  for (size_t i = 0; i < x.size(); ++i) xd[i] = dual<T>(x[i], v[i]);
+  auto fd = F_func(xd);
+  vector<T> out(fd.size());
+  for (size_t i = 0; i < fd.size(); ++i) out[i] = fd[i].deriv();
+  return out;
+}
+
 /// @brief Computes the numerical gradient of a vector function F: R^n -> R.
 template <typename F, typename T = double>
 vector<T> gradient(F F_func, const vector<T>& x, T h = T(1e-7)) {
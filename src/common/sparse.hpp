@@ -1,14 +1,31 @@
 #pragma once
 
+#include <charconv>
+#include <exception>
+#include <mutex>
+
 #include "../common/vector.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
+#include "../utility/mapped_file.hpp"
+#include "../utility/parallel.hpp"
 
 namespace numc {
 
 /// @addtogroup structures
 /// @{
 
+template <typename T>
+class sparse_builder;
+
+/// @brief Partition of the rows of a square sparse matrix into colors such that no two rows of the same
+/// color are coupled. All rows of one color can then be relaxed concurrently (multicolor Gauss-Seidel/SOR).
+struct sparse_coloring {
+  size_t colors = 0;
+  std::vector<size_t> color_ptr;  // Rows of color c are rows[color_ptr[c] .. color_ptr[c + 1]).
+  std::vector<size_t> rows;
+};
+
 /// @brief Sparse matrix in Compressed Sparse Row (CSR) format.
 template <typename T = double>
 class sparse_matrix {
@@ -20,6 +37,98 @@ class sparse_matrix {
   std::vector<size_t> _col_indices;
   std::vector<size_t> _row_ptr;
 
+  /// @brief Minimum amount of work (rows + nonzeros) per SpMV block before more threads are used.
+  static constexpr size_t _spmv_grain = size_t(1) << 15;
+
+  /// @brief Minimum vector length per thread for the dense BLAS-1 steps of the iterative solvers.
+  static constexpr size_t _vec_grain = size_t(1) << 15;
+
+  /// @brief Number of row blocks an SpMV is split into.
+  size_t _spmv_blocks() const {
+    size_t work = _rows + nnz();
+    return std::max<size_t>(1, std::min(utility::num_threads(), work / _spmv_grain));
+  }
+
+  /// @brief First row of block p out of `blocks`. Rows are split so that every block gets an equal
+  /// share of (rows + nonzeros), i.e. the merge-path diagonal taken at row granularity. Long rows
+  /// and many empty rows are both accounted for.
+  size_t _block_begin(size_t p, size_t blocks) const { return utility::weighted_split(_row_ptr, p, blocks); }
+
+  /// @brief Row-wise merge C = alpha * A + beta * B of two matrices with the same shape.
+  /// A symbolic pass counts the union of every row, then a numeric pass fills C; both run in parallel.
+  static sparse_matrix _add(const sparse_matrix& A, const sparse_matrix& B, T alpha, T beta) {
+    if (A._rows != B._rows || A._cols != B._cols) {
+      Log::Error("Sparse addition failed: shapes (" + std::to_string(A._rows) + " x " + std::to_string(A._cols) + ") and (" +
+                 std::to_string(B._rows) + " x " + std::to_string(B._cols) + ") do not match.");
+      throw std::invalid_argument("Shape mismatch for sparse addition.");
+    }
+    sparse_matrix C(A._rows, A._cols);
+    size_t grain = std::max<size_t>(1, _spmv_grain / 8);
+    utility::parallel_for(0, A._rows, grain, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        size_t p = A._row_ptr[i], pe = A._row_ptr[i + 1];
+        size_t q = B._row_ptr[i], qe = B._row_ptr[i + 1];
+        size_t count = 0;
+        while (p < pe && q < qe) {
+          size_t a = A._col_indices[p], b = B._col_indices[q];
+          p += (a <= b);
+          q += (b <= a);
+          ++count;
+        }
+        C._row_ptr[i + 1] = count + (pe - p) + (qe - q);
+      }
+    });
+    for (size_t i = 0; i < A._rows; ++i) C._row_ptr[i + 1] += C._row_ptr[i];
+    C._col_indices.resize(C._row_ptr[A._rows]);
+    C._values.resize(C._row_ptr[A._rows]);
+    utility::parallel_for(0, A._rows, grain, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        size_t p = A._row_ptr[i], pe = A._row_ptr[i + 1];
+        size_t q = B._row_ptr[i], qe = B._row_ptr[i + 1];
+        size_t out = C._row_ptr[i];
+        while (p < pe || q < qe) {
+          size_t a = (p < pe) ? A._col_indices[p] : SIZE_MAX;
+          size_t b = (q < qe) ? B._col_indices[q] : SIZE_MAX;
+          T v = T(0.0);
+          if (a <= b) v += alpha * A._values[p++];
+          if (b <= a) v += beta * B._values[q++];
+          C._col_indices[out] = std::min(a, b);
+          C._values[out++] = v;
+        }
+      }
+    });
+    return C;
+  }
+
+  /// @brief Validates the right-hand side of a solve.
+  void _check_rhs(const vector<T>& b) const {
+    if (b.size() != _rows) {
+      Log::Error("Sparse solve failed: right-hand side has size " + std::to_string(b.size()) + ", expected " + std::to_string(_rows) + ".");
+      throw std::invalid_argument("Right-hand side size must match the number of rows.");
+    }
+  }
+
+  /// @brief CSR kernel for rows [r0, r1). Four independent accumulators break the dependency chain
+  /// on the running sum so the compiler can issue the indirect loads of x as vector gathers.
+  void _multiply_rows(size_t r0, size_t r1, const T* x, T* y) const {
+    const size_t* rp = _row_ptr.data();
+    const size_t* ci = _col_indices.data();
+    const T* v = _values.data();
+    for (size_t i = r0; i < r1; ++i) {
+      size_t k = rp[i];
+      size_t end = rp[i + 1];
+      T s0 = T(0.0), s1 = T(0.0), s2 = T(0.0), s3 = T(0.0);
+      for (; k + 4 <= end; k += 4) {
+        s0 += v[k] * x[ci[k]];
+        s1 += v[k + 1] * x[ci[k + 1]];
+        s2 += v[k + 2] * x[ci[k + 2]];
+        s3 += v[k + 3] * x[ci[k + 3]];
+      }
+      for (; k < end; ++k) s0 += v[k] * x[ci[k]];
+      y[i] = (s0 + s1) + (s2 + s3);
+    }
+  }
+
  public:
   /// @brief Constructs an empty sparse matrix.
   sparse_matrix(size_t rows, size_t cols)
@@ -38,37 +147,65 @@ class sparse_matrix {
   /// @brief Returns the number of non-zero elements.
   size_t nnz() const { return _values.size(); }
 
-  /// @brief Constructs a sparse matrix from triplets (row, col, value).
-  static sparse_matrix from_triplets(
-      size_t rows, size_t cols,
-      const std::vector<std::tuple<size_t, size_t, T>>& triplets) {
-    sparse_matrix m(rows, cols);
+  /// @brief CSR row pointer array (size rows() + 1).
+  const std::vector<size_t>& row_ptr() const { return _row_ptr; }
 
-    // Sort triplets by row then column
-    auto sorted = triplets;
-    std::sort(sorted.begin(), sorted.end(),
-        [](const auto& a, const auto& b) {
-          if (std::get<0>(a) != std::get<0>(b)) return std::get<0>(a) < std::get<0>(b);
-          return std::get<1>(a) < std::get<1>(b);
-        });
+  /// @brief CSR column indices, sorted within every row.
+  const std::vector<size_t>& col_indices() const { return _col_indices; }
 
-    m._values.reserve(sorted.size());
-    m._col_indices.reserve(sorted.size());
+  /// @brief CSR values, aligned with col_indices().
+  const std::vector<T>& values() const { return _values; }
 
-    size_t current_row = 0;
-    m._row_ptr[0] = 0;
-    for (const auto& [r, c, v] : sorted) {
-      while (current_row < r) {
-        ++current_row;
-        m._row_ptr[current_row] = m._values.size();
+  /// @brief Mutable CSR values. The sparsity pattern itself cannot be changed through this accessor.
+  std::vector<T>& values() { return _values; }
+
+  /// @brief Returns the main diagonal (zeros where no entry is stored).
+  vector<T> diagonal() const {
+    size_t n = std::min(_rows, _cols);
+    vector<T> d(n);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+        if (_col_indices[k] == i) d[i] += _values[k];
       }
-      m._values.push_back(v);
-      m._col_indices.push_back(c);
     }
-    for (size_t i = current_row + 1; i <= rows; ++i) {
-      m._row_ptr[i] = m._values.size();
+    return d;
+  }
+
+  /// @brief Returns the value stored at (i, j), or zero if the entry is not part of the pattern.
+  T at(size_t i, size_t j) const {
+    if (i >= _rows || j >= _cols) throw std::out_of_range("Sparse matrix index out of bounds.");
+    auto first = _col_indices.begin() + _row_ptr[i];
+    auto last = _col_indices.begin() + _row_ptr[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    return (it != last && *it == j) ? _values[it - _col_indices.begin()] : T(0.0);
+  }
+
+  /// @brief Checks whether A equals its transpose, entry by entry, up to a relative tolerance.
+  bool is_symmetric(T tol = T(1e-12)) const {
+    if (_rows != _cols) return false;
+    for (size_t i = 0; i < _rows; ++i) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+        size_t j = _col_indices[k];
+        if (j == i) continue;
+        T a = _values[k];
+        T b = at(j, i);
+        if (std::abs(a - b) > tol * std::max(std::abs(a), std::abs(b))) return false;
+      }
     }
-    return m;
+    return true;
+  }
+
+  /// @brief Constructs a sparse matrix from triplets (row, col, value). Duplicate (row, col) entries
+  /// are summed, as finite element and finite volume assembly expects. Uses sparse_builder internally.
+  /// @throws std::out_of_range If an index is outside the matrix.
+  static sparse_matrix from_triplets(
+      size_t rows, size_t cols,
+      const std::vector<std::tuple<size_t, size_t, T>>& triplets) {
+    sparse_builder<T> builder(rows, cols);
+    builder.assemble(0, triplets.size(), [&](size_t lo, size_t hi, auto& sink) {
+      for (size_t k = lo; k < hi; ++k) sink.add(std::get<0>(triplets[k]), std::get<1>(triplets[k]), std::get<2>(triplets[k]));
+    });
+    return builder.build();
   }
 
   /// @brief Constructs a sparse identity matrix.
@@ -78,36 +215,239 @@ class sparse_matrix {
     return from_triplets(n, n, triplets);
   }
 
-  /// @brief Sparse matrix-vector multiplication: y = A * x.
-  vector<T> operator*(const vector<T>& x) const {
-    vector<T> y(_rows);
+  /// @brief Constructs a matrix directly from CSR arrays, which are moved in.
+  /// @throws std::invalid_argument If the arrays do not describe a valid CSR matrix with sorted,
+  /// duplicate-free column indices in every row.
+  static sparse_matrix from_csr(size_t rows, size_t cols, std::vector<size_t> row_ptr,
+                                std::vector<size_t> col_indices, std::vector<T> values) {
+    bool ok = row_ptr.size() == rows + 1 && row_ptr[0] == 0 && row_ptr[rows] == col_indices.size() &&
+              col_indices.size() == values.size();
+    for (size_t i = 0; ok && i < rows; ++i) {
+      if (row_ptr[i] > row_ptr[i + 1]) ok = false;
+      for (size_t k = row_ptr[i]; ok && k < row_ptr[i + 1]; ++k) {
+        if (col_indices[k] >= cols || (k > row_ptr[i] && col_indices[k] <= col_indices[k - 1])) ok = false;
+      }
+    }
+    if (!ok) {
+      Log::Error("Sparse matrix construction failed: inconsistent CSR arrays.");
+      throw std::invalid_argument("Invalid CSR arrays.");
+    }
+    sparse_matrix m(rows, cols);
+    m._row_ptr = std::move(row_ptr);
+    m._col_indices = std::move(col_indices);
+    m._values = std::move(values);
+    return m;
+  }
+
+  /// @brief Returns A^T in CSR form. A counting sort by column, O(rows + cols + nnz); the column
+  /// indices of the result come out sorted because the rows of A are visited in order.
+  sparse_matrix transpose() const {
+    sparse_matrix t(_cols, _rows);
+    for (size_t k = 0; k < nnz(); ++k) ++t._row_ptr[_col_indices[k] + 1];
+    for (size_t j = 0; j < _cols; ++j) t._row_ptr[j + 1] += t._row_ptr[j];
+    t._col_indices.resize(nnz());
+    t._values.resize(nnz());
+    std::vector<size_t> next(t._row_ptr.begin(), t._row_ptr.end() - 1);
     for (size_t i = 0; i < _rows; ++i) {
-      T sum = T(0.0);
       for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
-        sum += _values[k] * x[_col_indices[k]];
+        size_t p = next[_col_indices[k]]++;
+        t._col_indices[p] = i;
+        t._values[p] = _values[k];
       }
-      y[i] = sum;
     }
+    return t;
+  }
+
+  /// @brief Sparse matrix-matrix product C = A * B (Gustavson's row-by-row algorithm).
+  /// Rows are split into blocks of equal multiply-add count; every thread owns a dense accumulator
+  /// and marker array of size B.cols(). A symbolic pass sizes C exactly before the numeric pass.
+  /// @throws std::invalid_argument If cols() != B.rows().
+  sparse_matrix matmul(const sparse_matrix& B) const {
+    if (_cols != B._rows) {
+      Log::Error("Sparse matrix product failed: inner dimensions " + std::to_string(_cols) + " and " + std::to_string(B._rows) + " differ.");
+      throw std::invalid_argument("Inner dimensions must match for sparse matrix multiplication.");
+    }
+    sparse_matrix C(_rows, B._cols);
+    std::vector<size_t> flops(_rows + 1, 0);
+    for (size_t i = 0; i < _rows; ++i) {
+      size_t f = 0;
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) f += B._row_ptr[_col_indices[k] + 1] - B._row_ptr[_col_indices[k]];
+      flops[i + 1] = flops[i] + f;
+    }
+    size_t blocks = std::max<size_t>(1, std::min(utility::num_threads(), (_rows + flops[_rows]) / _spmv_grain));
+    auto for_blocks = [&](auto&& body) {
+      if (blocks == 1) return body(size_t(0), _rows);
+      utility::thread_pool::instance().run(blocks, [&](size_t p) {
+        body(utility::weighted_split(flops, p, blocks), utility::weighted_split(flops, p + 1, blocks));
+      });
+    };
+
+    for_blocks([&](size_t r0, size_t r1) {
+      std::vector<size_t> marker(B._cols, SIZE_MAX);
+      for (size_t i = r0; i < r1; ++i) {
+        size_t count = 0;
+        for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+          size_t r = _col_indices[k];
+          for (size_t q = B._row_ptr[r]; q < B._row_ptr[r + 1]; ++q) {
+            size_t j = B._col_indices[q];
+            if (marker[j] != i) {
+              marker[j] = i;
+              ++count;
+            }
+          }
+        }
+        C._row_ptr[i + 1] = count;
+      }
+    });
+    for (size_t i = 0; i < _rows; ++i) C._row_ptr[i + 1] += C._row_ptr[i];
+    C._col_indices.resize(C._row_ptr[_rows]);
+    C._values.resize(C._row_ptr[_rows]);
+
+    for_blocks([&](size_t r0, size_t r1) {
+      std::vector<T> acc(B._cols, T(0.0));
+      std::vector<size_t> marker(B._cols, SIZE_MAX);
+      for (size_t i = r0; i < r1; ++i) {
+        size_t begin = C._row_ptr[i], out = begin;
+        for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+          size_t r = _col_indices[k];
+          T a = _values[k];
+          for (size_t q = B._row_ptr[r]; q < B._row_ptr[r + 1]; ++q) {
+            size_t j = B._col_indices[q];
+            if (marker[j] != i) {
+              marker[j] = i;
+              C._col_indices[out++] = j;
+              acc[j] = a * B._values[q];
+            } else {
+              acc[j] += a * B._values[q];
+            }
+          }
+        }
+        std::sort(C._col_indices.begin() + begin, C._col_indices.begin() + out);
+        for (size_t p = begin; p < out; ++p) C._values[p] = acc[C._col_indices[p]];
+      }
+    });
+    return C;
+  }
+
+  /// @brief Compound sparse addition; the pattern of the result is the union of both patterns.
+  /// @throws std::invalid_argument If shapes do not match.
+  sparse_matrix& operator+=(const sparse_matrix& other) { return *this = _add(*this, other, T(1.0), T(1.0)); }
+
+  /// @brief Compound sparse subtraction; the pattern of the result is the union of both patterns.
+  /// @throws std::invalid_argument If shapes do not match.
+  sparse_matrix& operator-=(const sparse_matrix& other) { return *this = _add(*this, other, T(1.0), T(-1.0)); }
+
+  /// @brief Scales every stored value.
+  sparse_matrix& operator*=(T scalar) {
+    for (T& v : _values) v *= scalar;
+    return *this;
+  }
+
+  /// @brief Sparse matrix addition.
+  friend sparse_matrix operator+(const sparse_matrix& lhs, const sparse_matrix& rhs) { return _add(lhs, rhs, T(1.0), T(1.0)); }
+
+  /// @brief Sparse matrix subtraction.
+  friend sparse_matrix operator-(const sparse_matrix& lhs, const sparse_matrix& rhs) { return _add(lhs, rhs, T(1.0), T(-1.0)); }
+
+  /// @brief Sparse matrix-matrix multiplication.
+  friend sparse_matrix operator*(const sparse_matrix& lhs, const sparse_matrix& rhs) { return lhs.matmul(rhs); }
+
+  /// @brief Matrix-scalar multiplication.
+  friend sparse_matrix operator*(sparse_matrix m, T scalar) { return m *= scalar; }
+
+  /// @brief Scalar-matrix multiplication.
+  friend sparse_matrix operator*(T scalar, sparse_matrix m) { return m *= scalar; }
+
+  /// @brief Sparse matrix-vector multiplication into a caller-provided buffer: y = A * x.
+  /// Large matrices are split into nnz-balanced row blocks that run on the shared thread pool.
+  /// @param x Input vector of size cols(). Must not alias y.
+  /// @param y Output vector; resized to rows() if necessary, so it can be reused across calls.
+  /// @throws std::invalid_argument If x has the wrong size.
+  void multiply(const vector<T>& x, vector<T>& y) const {
+    if (x.size() != _cols) {
+      Log::Error("Sparse SpMV failed: vector size " + std::to_string(x.size()) + " does not match " + std::to_string(_cols) + " columns.");
+      throw std::invalid_argument("Vector size must match the number of columns for SpMV.");
+    }
+    if (y.size() != _rows) y.resize(_rows);
+    const T* xp = x.raw();
+    T* yp = y.raw();
+    size_t blocks = _spmv_blocks();
+    if (blocks <= 1) {
+      _multiply_rows(0, _rows, xp, yp);
+      return;
+    }
+    utility::thread_pool::instance().run(blocks, [&](size_t p) {
+      _multiply_rows(_block_begin(p, blocks), _block_begin(p + 1, blocks), xp, yp);
+    });
+  }
+
+  /// @brief Transposed product into a caller-provided buffer: y = A^T * x. The CSR rows are scattered into
+  /// y, so this runs serially; prefer transpose() once when A^T is applied many times.
+  /// @throws std::invalid_argument If x has the wrong size.
+  void transpose_multiply(const vector<T>& x, vector<T>& y) const {
+    if (x.size() != _rows) {
+      Log::Error("Sparse transposed SpMV failed: vector size " + std::to_string(x.size()) + " does not match " + std::to_string(_rows) + " rows.");
+      throw std::invalid_argument("Vector size must match the number of rows for a transposed SpMV.");
+    }
+    if (y.size() != _cols) y.resize(_cols);
+    T* yp = y.raw();
+    std::fill(yp, yp + _cols, T(0.0));
+    for (size_t i = 0; i < _rows; ++i) {
+      T xi = x[i];
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) yp[_col_indices[k]] += _values[k] * xi;
+    }
+  }
+
+  /// @brief Sparse matrix-vector multiplication: y = A * x.
+  vector<T> operator*(const vector<T>& x) const {
+    vector<T> y(_rows);
+    multiply(x, y);
     return y;
   }
 
   /// @brief Solves Ax = b using the Conjugate Gradient method (for SPD matrices).
+  /// All work vectors are allocated once; SpMV, dot products and updates run in parallel.
   vector<T> solve_cg(const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) const {
-    vector<T> x(_cols);  // initial guess = 0
-    vector<T> r = b;     // r = b - A*x = b
+    _check_rhs(b);
+    if (!is_symmetric()) Log::Warn("Sparse CG called on a nonsymmetric matrix; use linear_algebra::bicgstab or gmres instead.");
+    size_t n = _cols;
+    vector<T> x(n);  // initial guess = 0
+    vector<T> r = b;  // r = b - A*x = b
     vector<T> p = r;
-    T rs_old = r * r;
+    vector<T> Ap(_rows);
+    T* xp = x.raw();
+    T* rp = r.raw();
+    T* pp = p.raw();
+    const T* app = Ap.raw();
+
+    auto dot = [&](const T* u, const T* w) {
+      return utility::parallel_reduce<T>(0, n, _vec_grain, [&](size_t lo, size_t hi) {
+        T s = T(0.0);
+        for (size_t i = lo; i < hi; ++i) s += u[i] * w[i];
+        return s;
+      });
+    };
 
-    for (int i = 0; i < max_iter; ++i) {
-      vector<T> Ap = (*this) * p;
-      T pAp = p * Ap;
+    T rs_old = dot(rp, rp);
+    for (int it = 0; it < max_iter; ++it) {
+      multiply(p, Ap);
+      T pAp = dot(pp, app);
       if (std::abs(pAp) < T(1e-20)) break;
       T alpha = rs_old / pAp;
-      x = x + alpha * p;
-      r = r - alpha * Ap;
-      T rs_new = r * r;
+      T rs_new = utility::parallel_reduce<T>(0, n, _vec_grain, [&](size_t lo, size_t hi) {
+        T s = T(0.0);
+        for (size_t i = lo; i < hi; ++i) {
+          xp[i] += alpha * pp[i];
+          rp[i] -= alpha * app[i];
+          s += rp[i] * rp[i];
+        }
+        return s;
+      });
       if (std::sqrt(rs_new) < tol) return x;
-      p = r + (rs_new / rs_old) * p;
+      T beta = rs_new / rs_old;
+      utility::parallel_for(0, n, _vec_grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) pp[i] = rp[i] + beta * pp[i];
+      });
       rs_old = rs_new;
     }
     Log::Warn("Sparse CG did not converge.");
@@ -115,35 +455,46 @@ class sparse_matrix {
   }
 
   /// @brief Solves Ax = b using Jacobi iterative method.
+  /// Each sweep is x_new = x + D^-1 (b - A x), computed with the parallel SpMV; the two iterates swap
+  /// buffers instead of being copied.
   vector<T> solve_jacobi(const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) const {
-    vector<T> x(_cols);
-    vector<T> x_new(_cols);
+    _check_rhs(b);
+    size_t n = _cols;
+    vector<T> x(n);
+    vector<T> x_new(n);
+    vector<T> Ax(_rows);
+    vector<T> inv_diag(_rows);
+    for (size_t i = 0; i < _rows; ++i) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+        if (_col_indices[k] == i && std::abs(_values[k]) > T(1e-20)) inv_diag[i] = T(1.0) / _values[k];
+      }
+    }
+    const T* bp = b.raw();
+    const T* dp = inv_diag.raw();
+    const T* axp = Ax.raw();
 
     for (int iter = 0; iter < max_iter; ++iter) {
-      for (size_t i = 0; i < _rows; ++i) {
-        T sum = T(0.0);
-        T diag = T(0.0);
-        for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
-          if (_col_indices[k] == i) diag = _values[k];
-          else sum += _values[k] * x[_col_indices[k]];
-        }
-        if (std::abs(diag) > T(1e-20)) {
-          x_new[i] = (b[i] - sum) / diag;
+      multiply(x, Ax);
+      const T* xp = x.raw();
+      T* xnp = x_new.raw();
+      T norm_diff = utility::parallel_reduce<T>(0, n, _vec_grain, [&](size_t lo, size_t hi) {
+        T s = T(0.0);
+        for (size_t i = lo; i < hi; ++i) {
+          T d = (bp[i] - axp[i]) * dp[i];
+          xnp[i] = xp[i] + d;
+          s += d * d;
         }
-      }
-      T norm_diff = T(0.0);
-      for (size_t i = 0; i < _cols; ++i) {
-        T d = x_new[i] - x[i];
-        norm_diff += d * d;
-      }
-      x = x_new;
+        return s;
+      });
+      std::swap(x, x_new);
       if (std::sqrt(norm_diff) < tol) return x;
     }
     Log::Warn("Sparse Jacobi did not converge.");
     return x;
   }
 
-  /// @brief Solves Ax = b using Gauss-Seidel iterative method.
+  /// @brief Solves Ax = b using Gauss-Seidel iterative method (sequential natural ordering;
+  /// see solve_gauss_seidel_multicolor() for the parallel variant).
   vector<T> solve_gauss_seidel(const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) const {
     vector<T> x(_cols);
 
@@ -168,6 +519,288 @@ class sparse_matrix {
     return x;
   }
 
+  /// @brief Colors the adjacency graph of A + A^T. A two-coloring (red-black) is tried first by breadth-first
+  /// search, which succeeds for bipartite graphs such as 5- and 7-point stencils on structured grids;
+  /// otherwise rows get the smallest color not used by any neighbour (greedy coloring).
+  /// @throws std::invalid_argument If the matrix is not square.
+  sparse_coloring coloring() const {
+    if (_rows != _cols) {
+      Log::Error("Sparse coloring failed: matrix is not square.");
+      throw std::invalid_argument("Coloring requires a square matrix.");
+    }
+    const size_t npos = SIZE_MAX;
+    size_t n = _rows;
+    sparse_matrix t = transpose();
+    auto for_neighbours = [&](size_t i, auto&& f) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+        if (_col_indices[k] != i) f(_col_indices[k]);
+      }
+      for (size_t k = t._row_ptr[i]; k < t._row_ptr[i + 1]; ++k) {
+        if (t._col_indices[k] != i) f(t._col_indices[k]);
+      }
+    };
+
+    std::vector<size_t> color(n, npos);
+    bool bipartite = true;
+    std::vector<size_t> queue;
+    queue.reserve(n);
+    for (size_t s = 0; s < n && bipartite; ++s) {
+      if (color[s] != npos) continue;
+      color[s] = 0;
+      queue.assign(1, s);
+      for (size_t head = 0; head < queue.size() && bipartite; ++head) {
+        size_t i = queue[head];
+        for_neighbours(i, [&](size_t j) {
+          if (color[j] == npos) {
+            color[j] = 1 - color[i];
+            queue.push_back(j);
+          } else if (color[j] == color[i]) {
+            bipartite = false;
+          }
+        });
+      }
+    }
+
+    sparse_coloring c;
+    if (bipartite) {
+      c.colors = n > 0 ? 1 : 0;
+      for (size_t i = 0; i < n; ++i) c.colors = std::max(c.colors, color[i] + 1);
+    } else {
+      std::fill(color.begin(), color.end(), npos);
+      std::vector<size_t> forbidden;
+      for (size_t i = 0; i < n; ++i) {
+        for_neighbours(i, [&](size_t j) {
+          if (color[j] != npos) {
+            if (color[j] >= forbidden.size()) forbidden.resize(color[j] + 1, npos);
+            forbidden[color[j]] = i;
+          }
+        });
+        size_t col = 0;
+        while (col < forbidden.size() && forbidden[col] == i) ++col;
+        color[i] = col;
+        c.colors = std::max(c.colors, col + 1);
+      }
+    }
+
+    c.color_ptr.assign(c.colors + 1, 0);
+    for (size_t i = 0; i < n; ++i) ++c.color_ptr[color[i] + 1];
+    for (size_t k = 0; k < c.colors; ++k) c.color_ptr[k + 1] += c.color_ptr[k];
+    c.rows.resize(n);
+    std::vector<size_t> next(c.color_ptr.begin(), c.color_ptr.end() - 1);
+    for (size_t i = 0; i < n; ++i) c.rows[next[color[i]]++] = i;
+    return c;
+  }
+
+  /// @brief One multicolor SOR sweep on x in place: the colors are visited in order (reverse order if
+  /// forward is false, which makes a forward + backward pair symmetric) and all rows of a color are
+  /// relaxed in parallel: x_i += omega * (b_i - sum_j a_ij x_j) / a_ii. Rows with a zero diagonal are skipped.
+  /// @param colors A coloring of this matrix, see coloring().
+  /// @return The squared 2-norm of the update.
+  T sor_sweep(const sparse_coloring& colors, const vector<T>& b, vector<T>& x, T omega = T(1.0), bool forward = true) const {
+    const size_t* rp = _row_ptr.data();
+    const size_t* ci = _col_indices.data();
+    const T* v = _values.data();
+    const T* bp = b.raw();
+    T* xp = x.raw();
+    T change = T(0.0);
+    for (size_t step = 0; step < colors.colors; ++step) {
+      size_t c = forward ? step : colors.colors - 1 - step;
+      const size_t* rows = colors.rows.data();
+      change += utility::parallel_reduce<T>(colors.color_ptr[c], colors.color_ptr[c + 1], _vec_grain / 8, [&](size_t lo, size_t hi) {
+        T s = T(0.0);
+        for (size_t q = lo; q < hi; ++q) {
+          size_t i = rows[q];
+          T sum = bp[i], diag = T(0.0);
+          for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+            if (ci[k] == i) diag = v[k];
+            sum -= v[k] * xp[ci[k]];
+          }
+          if (std::abs(diag) > T(1e-20)) {
+            T d = omega * sum / diag;
+            xp[i] += d;
+            s += d * d;
+          }
+        }
+        return s;
+      });
+    }
+    return change;
+  }
+
+  /// @brief Solves Ax = b with multicolor successive over-relaxation; omega = 1 is Gauss-Seidel.
+  /// Every color is swept in parallel, see coloring() and sor_sweep(). Stops when the 2-norm of the update
+  /// drops below tol.
+  /// @throws std::invalid_argument If omega is outside (0, 2) or b has the wrong size.
+  vector<T> solve_sor(const vector<T>& b, T omega = T(1.0), T tol = T(1e-8), int max_iter = 10000) const {
+    _check_rhs(b);
+    if (omega <= T(0.0) || omega >= T(2.0)) {
+      Log::Error("Sparse SOR: omega must lie in (0, 2).");
+      throw std::invalid_argument("SOR relaxation factor out of range.");
+    }
+    sparse_coloring colors = coloring();
+    vector<T> x(_cols);
+    for (int iter = 0; iter < max_iter; ++iter) {
+      if (std::sqrt(sor_sweep(colors, b, x, omega)) < tol) return x;
+    }
+    Log::Warn("Sparse SOR did not converge.");
+    return x;
+  }
+
+  /// @brief Solves Ax = b with multicolor Gauss-Seidel, the parallel counterpart of solve_gauss_seidel().
+  vector<T> solve_gauss_seidel_multicolor(const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) const {
+    return solve_sor(b, T(1.0), tol, max_iter);
+  }
+
+  /// @brief Reads a matrix in Matrix Market coordinate format (real, integer or pattern field;
+  /// general, symmetric or skew-symmetric storage).
+  /// The file is memory-mapped and split into byte ranges aligned to line breaks; every thread parses
+  /// its range with std::from_chars and feeds a sparse_builder sink, so duplicates are summed and CSR is
+  /// built without an intermediate triplet list. Symmetric files are expanded to both triangles.
+  /// @throws std::runtime_error If the file cannot be read or is not a valid coordinate Matrix Market file.
+  static sparse_matrix load_mtx(const std::string& filename) {
+    utility::mapped_file file(filename);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    auto fail = [&](const std::string& what) {
+      Log::Error("Matrix Market read failed (" + filename + "): " + what);
+      throw std::runtime_error("Invalid Matrix Market file " + filename);
+    };
+    auto next_line = [&](const char* p) {
+      p = std::find(p, end, '\n');
+      return p == end ? end : p + 1;
+    };
+
+    // Header: %%MatrixMarket matrix coordinate <field> <symmetry>
+    const char* line_end = std::find(begin, end, '\n');
+    std::string header(begin, line_end);
+    std::transform(header.begin(), header.end(), header.begin(), [](unsigned char c) { return std::tolower(c); });
+    std::istringstream hs(header);
+    std::string banner, object, format, field, symmetry;
+    hs >> banner >> object >> format >> field >> symmetry;
+    if (banner != "%%matrixmarket" || object != "matrix") fail("missing %%MatrixMarket matrix header.");
+    if (format != "coordinate") fail("only the coordinate format is supported.");
+    if (field != "real" && field != "integer" && field != "double" && field != "pattern") fail("unsupported field '" + field + "'.");
+    if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric") fail("unsupported symmetry '" + symmetry + "'.");
+    const bool pattern = field == "pattern";
+    const bool symmetric = symmetry != "general";
+    const T mirror = symmetry == "skew-symmetric" ? T(-1.0) : T(1.0);
+    if (symmetric && pattern && mirror < T(0.0)) fail("skew-symmetric pattern matrices are not defined.");
+
+    // Size line, after any comments.
+    const char* p = next_line(begin);
+    while (p < end && (*p == '%' || *p == '\n' || *p == '\r')) p = next_line(p);
+    size_t dims[3];
+    for (size_t& d : dims) {
+      while (p < end && (*p == ' ' || *p == '\t')) ++p;
+      auto [q, ec] = std::from_chars(p, end, d);
+      if (ec != std::errc()) fail("malformed size line.");
+      p = q;
+    }
+    const size_t rows = dims[0], cols = dims[1], entries = dims[2];
+    if (symmetric && rows != cols) fail("symmetric storage requires a square matrix.");
+    const char* data = next_line(p);
+    const size_t offset = static_cast<size_t>(data - begin);
+
+    sparse_builder<T> builder(rows, cols);
+    std::atomic<size_t> parsed{0};
+    std::atomic<bool> bad{false};
+    builder.assemble(offset, file.size(), [&](size_t lo, size_t hi, auto& sink) {
+      // A chunk owns every line that starts inside [lo, hi).
+      const char* c = begin + lo;
+      if (lo != offset && c[-1] != '\n') c = next_line(c);
+      const char* stop = begin + hi;
+      size_t count = 0;
+      while (c < stop && c < end) {
+        const char* e = std::find(c, end, '\n');
+        while (c < e && (*c == ' ' || *c == '\t')) ++c;
+        if (c == e || *c == '%' || *c == '\r') {
+          c = (e == end) ? end : e + 1;
+          continue;
+        }
+        size_t i = 0, j = 0;
+        T v = T(1.0);
+        auto r1 = std::from_chars(c, e, i);
+        const char* q = r1.ptr;
+        while (q < e && (*q == ' ' || *q == '\t')) ++q;
+        auto r2 = std::from_chars(q, e, j);
+        q = r2.ptr;
+        bool ok = r1.ec == std::errc() && r2.ec == std::errc() && i >= 1 && j >= 1 && i <= rows && j <= cols;
+        if (ok && !pattern) {
+          while (q < e && (*q == ' ' || *q == '\t')) ++q;
+          auto r3 = std::from_chars(q, e, v);
+          ok = r3.ec == std::errc();
+        }
+        if (!ok) {
+          bad = true;
+          return;
+        }
+        sink.add(i - 1, j - 1, v);
+        if (symmetric && i != j) sink.add(j - 1, i - 1, mirror * v);
+        ++count;
+        c = (e == end) ? end : e + 1;
+      }
+      parsed += count;
+    });
+    if (bad) fail("malformed entry line.");
+    if (parsed != entries) fail("expected " + std::to_string(entries) + " entries, found " + std::to_string(parsed.load()) + ".");
+    return builder.build();
+  }
+
+  /// @brief Writes the matrix in Matrix Market coordinate real format with 1-based indices.
+  /// Values are printed with std::to_chars (shortest form that reads back exactly), rows are formatted
+  /// in parallel blocks and written in order.
+  /// @param symmetric Store only the lower triangle under a "symmetric" header.
+  /// @throws std::invalid_argument If symmetric storage is requested for a nonsymmetric matrix.
+  /// @throws std::runtime_error If the file cannot be written.
+  void save_mtx(const std::string& filename, bool symmetric = false) const {
+    if (symmetric && !is_symmetric(T(0.0))) {
+      Log::Error("Matrix Market write failed: matrix is not symmetric.");
+      throw std::invalid_argument("Symmetric storage requested for a nonsymmetric matrix.");
+    }
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+      Log::Error("Failed to open file: " + filename);
+      throw std::runtime_error("Could not open file " + filename);
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < _rows; ++i) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) count += !symmetric || _col_indices[k] <= i;
+    }
+    out << "%%MatrixMarket matrix coordinate real " << (symmetric ? "symmetric" : "general") << "\n";
+    out << _rows << " " << _cols << " " << count << "\n";
+
+    size_t blocks = std::max<size_t>(1, std::min(utility::num_threads() * 4, nnz() / _spmv_grain));
+    std::vector<std::string> text(std::min(blocks, utility::num_threads()));
+    // Format groups of blocks in parallel, then write them in order, so memory stays bounded.
+    for (size_t first = 0; first < blocks; first += text.size()) {
+      size_t group = std::min(text.size(), blocks - first);
+      utility::thread_pool::instance().run(group, [&](size_t g) {
+        std::string& buf = text[g];
+        buf.clear();
+        char tmp[96];  // two indices and a value always fit in 80 characters
+        for (size_t i = _block_begin(first + g, blocks); i < _block_begin(first + g + 1, blocks); ++i) {
+          for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) {
+            if (symmetric && _col_indices[k] > i) continue;
+            char* q = std::to_chars(tmp, tmp + 24, i + 1).ptr;
+            *q++ = ' ';
+            q = std::to_chars(q, q + 24, _col_indices[k] + 1).ptr;
+            *q++ = ' ';
+            q = std::to_chars(q, q + 32, _values[k]).ptr;
+            *q++ = '\n';
+            buf.append(tmp, q);
+          }
+        }
+      });
+      for (size_t g = 0; g < group; ++g) {
+        out.write(text[g].data(), static_cast<std::streamsize>(text[g].size()));
+      }
+    }
+    if (!out) {
+      Log::Error("Matrix Market write failed: error while writing " + filename + ".");
+      throw std::runtime_error("Could not write file " + filename);
+    }
+  }
+
   /// @brief Prints the sparse matrix in a readable format.
   friend std::ostream& operator<<(std::ostream& os, const sparse_matrix& m) {
     os << "Sparse matrix (" << m._rows << " x " << m._cols << "), nnz = " << m.nnz() << "\n";
@@ -180,6 +813,310 @@ class sparse_matrix {
   }
 };
 
+/// @brief Assembly builder for sparse_matrix: collects (row, col, value) contributions, possibly from
+/// several threads at once, and turns them into CSR with duplicate entries summed.
+///
+/// Every thread writes to its own COO buffer, so insertion needs no locking. build() sorts the
+/// buffers with a parallel counting sort by row followed by a per-row sort by column.
+/// When the same sparsity pattern is assembled repeatedly (time stepping, Newton iterations), call
+/// build(true) once to freeze the pattern: later contributions are added straight into the CSR
+/// values of the frozen matrix and build() returns without sorting anything.
+template <typename T = double>
+class sparse_builder {
+ private:
+  struct entry {
+    size_t row, col;
+    T value;
+  };
+
+  struct slot {
+    size_t col;
+    T value;
+  };
+
+  size_t _rows, _cols;
+  std::vector<std::vector<entry>> _buffers;
+  bool _frozen = false;
+  sparse_matrix<T> _pattern;
+
+  static constexpr size_t _grain = size_t(1) << 14;
+
+  void _check_index(size_t i, size_t j) const {
+    if (i >= _rows || j >= _cols) {
+      Log::Error("Sparse assembly failed: entry (" + std::to_string(i) + ", " + std::to_string(j) + ") lies outside a " +
+                 std::to_string(_rows) + " x " + std::to_string(_cols) + " matrix.");
+      throw std::out_of_range("Sparse matrix index out of bounds.");
+    }
+  }
+
+  /// @brief Position of (i, j) in the frozen CSR arrays.
+  size_t _position(size_t i, size_t j) const {
+    const auto& ci = _pattern.col_indices();
+    auto first = ci.begin() + _pattern.row_ptr()[i];
+    auto last = ci.begin() + _pattern.row_ptr()[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    if (it == last || *it != j) {
+      Log::Error("Sparse assembly failed: entry (" + std::to_string(i) + ", " + std::to_string(j) + ") is not part of the frozen pattern.");
+      throw std::out_of_range("Entry outside the frozen sparsity pattern.");
+    }
+    return static_cast<size_t>(it - ci.begin());
+  }
+
+ public:
+  /// @brief Insertion handle owned by one thread during assemble().
+  class sink {
+   private:
+    sparse_builder* _b;
+    std::vector<entry>* _buffer;
+    bool _concurrent;
+
+   public:
+    sink(sparse_builder* b, std::vector<entry>* buffer, bool concurrent) : _b(b), _buffer(buffer), _concurrent(concurrent) {}
+
+    /// @brief Adds value to entry (i, j).
+    /// @throws std::out_of_range If (i, j) is outside the matrix or, once frozen, outside the pattern.
+    void add(size_t i, size_t j, T value) {
+      _b->_check_index(i, j);
+      if (!_b->_frozen) {
+        _buffer->push_back({i, j, value});
+        return;
+      }
+      T& target = _b->_pattern.values()[_b->_position(i, j)];
+      if (_concurrent) std::atomic_ref<T>(target).fetch_add(value, std::memory_order_relaxed);
+      else target += value;
+    }
+  };
+
+  /// @brief Constructs an empty builder for a rows x cols matrix.
+  sparse_builder(size_t rows, size_t cols) : _rows(rows), _cols(cols), _buffers(1), _pattern(rows, cols) {}
+
+  /// @brief Returns the number of rows.
+  size_t rows() const { return _rows; }
+
+  /// @brief Returns the number of columns.
+  size_t cols() const { return _cols; }
+
+  /// @brief Whether the sparsity pattern has been frozen by build(true).
+  bool frozen() const { return _frozen; }
+
+  /// @brief Reserves room for n entries in the serial buffer.
+  void reserve(size_t n) { _buffers[0].reserve(n); }
+
+  /// @brief Adds value to entry (i, j) from the calling thread. Not safe to call concurrently; use assemble() for that.
+  /// @throws std::out_of_range If (i, j) is outside the matrix or, once frozen, outside the pattern.
+  void add(size_t i, size_t j, T value) { sink(this, &_buffers[0], false).add(i, j, value); }
+
+  /// @brief Parallel assembly: splits [begin, end) into contiguous chunks and calls body(lo, hi, sink)
+  /// for each chunk on the thread pool. Every chunk inserts through its own sink and COO buffer.
+  /// An exception thrown by body or a sink on a worker is caught there and rethrown here after all chunks
+  /// have finished; the contributions made before it are kept, so call reset() before reusing the builder.
+  /// @throws std::out_of_range If an entry is outside the matrix or, once frozen, outside the pattern.
+  template <typename F>
+  void assemble(size_t begin, size_t end, F&& body) {
+    if (end <= begin) return;
+    size_t n = end - begin;
+    size_t chunks = std::min(utility::num_threads(), std::max<size_t>(1, n / _grain));
+    if (_buffers.size() < chunks) _buffers.resize(chunks);
+    if (chunks == 1) {
+      sink s(this, &_buffers[0], false);
+      body(begin, end, s);
+      return;
+    }
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    utility::thread_pool::instance().run(chunks, [&](size_t c) {
+      try {
+        sink s(this, &_buffers[c], true);
+        body(begin + n * c / chunks, begin + n * (c + 1) / chunks, s);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+    });
+    if (error) std::rethrow_exception(error);
+  }
+
+  /// @brief Produces the CSR matrix and empties the builder.
+  /// @param freeze_pattern Keep the resulting pattern: later contributions are scattered directly into its
+  /// values, and each build() returns the accumulated values and resets them to zero.
+  sparse_matrix<T> build(bool freeze_pattern = false) {
+    if (_frozen) {
+      sparse_matrix<T> result = _pattern;
+      std::fill(_pattern.values().begin(), _pattern.values().end(), T(0.0));
+      return result;
+    }
+
+    // Counting sort by row: every buffer gets its own slice of every row, so the scatter is race-free.
+    size_t nb = _buffers.size();
+    std::vector<std::vector<size_t>> offset(nb, std::vector<size_t>(_rows + 1, 0));
+    utility::thread_pool::instance().run(nb, [&](size_t b) {
+      for (const entry& e : _buffers[b]) ++offset[b][e.row];
+    });
+    std::vector<size_t> row_start(_rows + 1, 0);
+    size_t total = 0;
+    for (size_t i = 0; i < _rows; ++i) {
+      row_start[i] = total;
+      for (size_t b = 0; b < nb; ++b) {
+        size_t c = offset[b][i];
+        offset[b][i] = total;
+        total += c;
+      }
+    }
+    row_start[_rows] = total;
+    std::vector<slot> sorted(total);
+    utility::thread_pool::instance().run(nb, [&](size_t b) {
+      for (const entry& e : _buffers[b]) sorted[offset[b][e.row]++] = {e.col, e.value};
+    });
+    _buffers.assign(1, {});
+    offset.clear();
+
+    // Per row: sort by column and sum duplicates in place, then compact into CSR.
+    std::vector<size_t> row_ptr(_rows + 1, 0);
+    utility::parallel_for(0, _rows, _grain / 16, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        slot* first = sorted.data() + row_start[i];
+        slot* last = sorted.data() + row_start[i + 1];
+        std::sort(first, last, [](const slot& a, const slot& b) { return a.col < b.col; });
+        slot* out = first;
+        for (slot* it = first; it != last; ++it) {
+          if (out != first && (out - 1)->col == it->col) (out - 1)->value += it->value;
+          else *out++ = *it;
+        }
+        row_ptr[i + 1] = static_cast<size_t>(out - first);
+      }
+    });
+    for (size_t i = 0; i < _rows; ++i) row_ptr[i + 1] += row_ptr[i];
+    std::vector<size_t> col_indices(row_ptr[_rows]);
+    std::vector<T> values(row_ptr[_rows]);
+    utility::parallel_for(0, _rows, _grain / 16, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        const slot* src = sorted.data() + row_start[i];
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k, ++src) {
+          col_indices[k] = src->col;
+          values[k] = src->value;
+        }
+      }
+    });
+
+    sparse_matrix<T> result = sparse_matrix<T>::from_csr(_rows, _cols, std::move(row_ptr), std::move(col_indices), std::move(values));
+    if (freeze_pattern) {
+      _pattern = result;
+      std::fill(_pattern.values().begin(), _pattern.values().end(), T(0.0));
+      _frozen = true;
+    }
+    return result;
+  }
+
+  /// @brief Drops the frozen pattern and any pending entries; the builder starts over.
+  void reset() {
+    _buffers.assign(1, {});
+    _pattern = sparse_matrix<T>(_rows, _cols);
+    _frozen = false;
+  }
+};
+
+/// @brief Sparse matrix in Compressed Sparse Column (CSC) format, the column-oriented companion of
+/// sparse_matrix. Column access is cheap, which suits column-wise factorizations and A^T x products.
+/// The CSC arrays of A are exactly the CSR arrays of A^T, so conversions are a single transpose.
+template <typename T = double>
+class sparse_matrix_csc {
+  static_assert(std::is_floating_point<T>::value, "numc::sparse_matrix_csc supports floating-point types only!");
+
+ private:
+  /// @brief A^T stored in CSR, which is A in CSC.
+  sparse_matrix<T> _t;
+
+  static constexpr size_t _grain = size_t(1) << 15;
+
+ public:
+  /// @brief Constructs an empty matrix.
+  sparse_matrix_csc(size_t rows, size_t cols) : _t(cols, rows) {}
+
+  /// @brief Converts a CSR matrix in O(rows + cols + nnz).
+  explicit sparse_matrix_csc(const sparse_matrix<T>& A) : _t(A.transpose()) {}
+
+  /// @brief Constructs a matrix directly from CSC arrays, which are moved in.
+  /// @throws std::invalid_argument If the arrays are inconsistent or row indices are unsorted within a column.
+  static sparse_matrix_csc from_csc(size_t rows, size_t cols, std::vector<size_t> col_ptr,
+                                    std::vector<size_t> row_indices, std::vector<T> values) {
+    sparse_matrix_csc m(rows, cols);
+    m._t = sparse_matrix<T>::from_csr(cols, rows, std::move(col_ptr), std::move(row_indices), std::move(values));
+    return m;
+  }
+
+  /// @brief Returns the number of rows.
+  size_t rows() const { return _t.cols(); }
+
+  /// @brief Returns the number of columns.
+  size_t cols() const { return _t.rows(); }
+
+  /// @brief Returns the number of non-zero elements.
+  size_t nnz() const { return _t.nnz(); }
+
+  /// @brief CSC column pointer array (size cols() + 1).
+  const std::vector<size_t>& col_ptr() const { return _t.row_ptr(); }
+
+  /// @brief CSC row indices, sorted within every column.
+  const std::vector<size_t>& row_indices() const { return _t.col_indices(); }
+
+  /// @brief CSC values, aligned with row_indices().
+  const std::vector<T>& values() const { return _t.values(); }
+
+  /// @brief Mutable CSC values. The sparsity pattern itself cannot be changed through this accessor.
+  std::vector<T>& values() { return _t.values(); }
+
+  /// @brief Returns the value stored at (i, j), or zero if the entry is not part of the pattern.
+  T at(size_t i, size_t j) const { return _t.at(j, i); }
+
+  /// @brief Converts back to CSR.
+  sparse_matrix<T> to_csr() const { return _t.transpose(); }
+
+  /// @brief Returns A^T in CSR form. No conversion is needed: it shares the arrays of this matrix.
+  const sparse_matrix<T>& transpose() const { return _t; }
+
+  /// @brief y = A * x as a column-by-column scatter. Runs serially, since columns write to shared rows.
+  /// @throws std::invalid_argument If x has the wrong size.
+  void multiply(const vector<T>& x, vector<T>& y) const {
+    if (x.size() != cols()) {
+      Log::Error("CSC SpMV failed: vector size " + std::to_string(x.size()) + " does not match " + std::to_string(cols()) + " columns.");
+      throw std::invalid_argument("Vector size must match the number of columns for SpMV.");
+    }
+    if (y.size() != rows()) y.resize(rows());
+    const size_t* cp = _t.row_ptr().data();
+    const size_t* ri = _t.col_indices().data();
+    const T* v = _t.values().data();
+    const T* xp = x.raw();
+    T* yp = y.raw();
+    std::fill(yp, yp + rows(), T(0.0));
+    for (size_t j = 0; j < cols(); ++j) {
+      T xj = xp[j];
+      if (xj == T(0.0)) continue;
+      for (size_t k = cp[j]; k < cp[j + 1]; ++k) yp[ri[k]] += v[k] * xj;
+    }
+  }
+
+  /// @brief y = A^T * x, one dot product per column; parallel like the CSR SpMV.
+  void transpose_multiply(const vector<T>& x, vector<T>& y) const { _t.multiply(x, y); }
+
+  /// @brief Sparse matrix-vector multiplication: y = A * x.
+  vector<T> operator*(const vector<T>& x) const {
+    vector<T> y(rows());
+    multiply(x, y);
+    return y;
+  }
+
+  /// @brief Prints the sparse matrix in a readable format.
+  friend std::ostream& operator<<(std::ostream& os, const sparse_matrix_csc& m) {
+    os << "Sparse CSC matrix (" << m.rows() << " x " << m.cols() << "), nnz = " << m.nnz() << "\n";
+    for (size_t j = 0; j < m.cols(); ++j) {
+      for (size_t k = m.col_ptr()[j]; k < m.col_ptr()[j + 1]; ++k) {
+        os << "  (" << m.row_indices()[k] << ", " << j << ") = " << m.values()[k] << "\n";
+      }
+    }
+    return os;
+  }
+};
+
 /// @}
 
 }  // namespace numc
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <concepts>
+
+#include "../common/sparse.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+
+namespace numc {
+
+/// @addtogroup structures
+/// @{
+
+/// @brief Common interface of every sparse storage format (CSR, CSC, BSR, SELL-C-sigma): the dimensions
+/// and an SpMV y = A * x into a caller-provided buffer. The Krylov solvers accept any such type.
+template <typename Matrix, typename T>
+concept sparse_operator = requires(const Matrix& A, const vector<T>& x, vector<T>& y) {
+  { A.rows() } -> std::convertible_to<size_t>;
+  { A.cols() } -> std::convertible_to<size_t>;
+  A.multiply(x, y);
+};
+
+/// @brief Sparse matrix in Block Compressed Sparse Row (BSR) format with square dense blocks.
+/// Suited to matrices with a natural block structure, e.g. 3 x 3 or 6 x 6 blocks from elasticity with
+/// 3 or 6 degrees of freedom per node: one column index serves a whole block, and the block product runs
+/// on contiguous memory. Block sizes 2, 3, 4 and 6 use unrolled kernels.
+template <typename T = double>
+class bsr_matrix {
+  static_assert(std::is_floating_point<T>::value, "numc::bsr_matrix supports floating-point types only!");
+
+ private:
+  size_t _rows, _cols, _b;
+  std::vector<size_t> _block_row_ptr;
+  std::vector<size_t> _block_cols;
+  std::vector<T> _values;  // Blocks stored one after another, each row-major.
+
+  static constexpr size_t _grain = size_t(1) << 15;
+
+  template <size_t B>
+  void _multiply_fixed(size_t br0, size_t br1, const T* x, T* y) const {
+    for (size_t br = br0; br < br1; ++br) {
+      T acc[B] = {};
+      for (size_t k = _block_row_ptr[br]; k < _block_row_ptr[br + 1]; ++k) {
+        const T* blk = _values.data() + k * B * B;
+        const T* xb = x + _block_cols[k] * B;
+        for (size_t r = 0; r < B; ++r) {
+          for (size_t c = 0; c < B; ++c) acc[r] += blk[r * B + c] * xb[c];
+        }
+      }
+      for (size_t r = 0; r < B; ++r) y[br * B + r] = acc[r];
+    }
+  }
+
+  void _multiply_generic(size_t br0, size_t br1, const T* x, T* y) const {
+    size_t b = _b;
+    for (size_t br = br0; br < br1; ++br) {
+      T* yb = y + br * b;
+      std::fill(yb, yb + b, T(0.0));
+      for (size_t k = _block_row_ptr[br]; k < _block_row_ptr[br + 1]; ++k) {
+        const T* blk = _values.data() + k * b * b;
+        const T* xb = x + _block_cols[k] * b;
+        for (size_t r = 0; r < b; ++r) {
+          T s = T(0.0);
+          for (size_t c = 0; c < b; ++c) s += blk[r * b + c] * xb[c];
+          yb[r] += s;
+        }
+      }
+    }
+  }
+
+  void _multiply_rows(size_t br0, size_t br1, const T* x, T* y) const {
+    switch (_b) {
+      case 1: _multiply_fixed<1>(br0, br1, x, y); break;
+      case 2: _multiply_fixed<2>(br0, br1, x, y); break;
+      case 3: _multiply_fixed<3>(br0, br1, x, y); break;
+      case 4: _multiply_fixed<4>(br0, br1, x, y); break;
+      case 6: _multiply_fixed<6>(br0, br1, x, y); break;
+      default: _multiply_generic(br0, br1, x, y); break;
+    }
+  }
+
+ public:
+  /// @brief Converts a CSR matrix into blocks of size block_size x block_size. Entries missing from a
+  /// stored block are kept as explicit zeros.
+  /// @throws std::invalid_argument If the dimensions are not multiples of block_size.
+  bsr_matrix(const sparse_matrix<T>& A, size_t block_size) : _rows(A.rows()), _cols(A.cols()), _b(block_size) {
+    if (_b == 0 || _rows % _b != 0 || _cols % _b != 0) {
+      Log::Error("BSR conversion failed: " + std::to_string(_rows) + " x " + std::to_string(_cols) +
+                 " matrix is not divisible into blocks of size " + std::to_string(_b) + ".");
+      throw std::invalid_argument("Matrix dimensions must be multiples of the block size.");
+    }
+    size_t nbr = _rows / _b, nbc = _cols / _b;
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    const auto& v = A.values();
+
+    // Distinct block columns of every block row.
+    _block_row_ptr.assign(nbr + 1, 0);
+    std::vector<std::vector<size_t>> cols_of(nbr);
+    utility::parallel_for(0, nbr, std::max<size_t>(1, _grain / (_b * 8)), [&](size_t lo, size_t hi) {
+      std::vector<size_t> marker(nbc, SIZE_MAX);
+      for (size_t br = lo; br < hi; ++br) {
+        for (size_t i = br * _b; i < (br + 1) * _b; ++i) {
+          for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+            size_t bc = ci[k] / _b;
+            if (marker[bc] != br) {
+              marker[bc] = br;
+              cols_of[br].push_back(bc);
+            }
+          }
+        }
+        std::sort(cols_of[br].begin(), cols_of[br].end());
+      }
+    });
+    for (size_t br = 0; br < nbr; ++br) _block_row_ptr[br + 1] = _block_row_ptr[br] + cols_of[br].size();
+    _block_cols.resize(_block_row_ptr[nbr]);
+    _values.assign(_block_row_ptr[nbr] * _b * _b, T(0.0));
+
+    utility::parallel_for(0, nbr, std::max<size_t>(1, _grain / (_b * 8)), [&](size_t lo, size_t hi) {
+      for (size_t br = lo; br < hi; ++br) {
+        size_t base = _block_row_ptr[br];
+        std::copy(cols_of[br].begin(), cols_of[br].end(), _block_cols.begin() + base);
+        for (size_t i = br * _b; i < (br + 1) * _b; ++i) {
+          size_t slot = base;
+          for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+            size_t bc = ci[k] / _b;
+            while (_block_cols[slot] != bc) ++slot;  // both sequences are sorted
+            _values[(slot * _b + (i % _b)) * _b + ci[k] % _b] = v[k];
+          }
+        }
+      }
+    });
+  }
+
+  /// @brief Returns the number of rows.
+  size_t rows() const { return _rows; }
+
+  /// @brief Returns the number of columns.
+  size_t cols() const { return _cols; }
+
+  /// @brief Returns the block size.
+  size_t block_size() const { return _b; }
+
+  /// @brief Returns the number of stored blocks.
+  size_t nnz_blocks() const { return _block_cols.size(); }
+
+  /// @brief Returns the number of stored values, including explicit zeros inside blocks.
+  size_t nnz() const { return _values.size(); }
+
+  /// @brief Block row pointer array (size rows() / block_size() + 1).
+  const std::vector<size_t>& block_row_ptr() const { return _block_row_ptr; }
+
+  /// @brief Block column indices, sorted within every block row.
+  const std::vector<size_t>& block_cols() const { return _block_cols; }
+
+  /// @brief Block values; block k occupies [k * b * b, (k + 1) * b * b) in row-major order.
+  const std::vector<T>& values() const { return _values; }
+
+  /// @brief Block SpMV into a caller-provided buffer: y = A * x, in parallel over balanced block rows.
+  /// @throws std::invalid_argument If x has the wrong size.
+  void multiply(const vector<T>& x, vector<T>& y) const {
+    if (x.size() != _cols) {
+      Log::Error("BSR SpMV failed: vector size " + std::to_string(x.size()) + " does not match " + std::to_string(_cols) + " columns.");
+      throw std::invalid_argument("Vector size must match the number of columns for SpMV.");
+    }
+    if (y.size() != _rows) y.resize(_rows);
+    const T* xp = x.raw();
+    T* yp = y.raw();
+    size_t nbr = _block_row_ptr.size() - 1;
+    size_t blocks = std::max<size_t>(1, std::min(utility::num_threads(), (_rows + nnz()) / _grain));
+    if (blocks <= 1) {
+      _multiply_rows(0, nbr, xp, yp);
+      return;
+    }
+    utility::thread_pool::instance().run(blocks, [&](size_t p) {
+      _multiply_rows(utility::weighted_split(_block_row_ptr, p, blocks), utility::weighted_split(_block_row_ptr, p + 1, blocks), xp, yp);
+    });
+  }
+
+  /// @brief Sparse matrix-vector multiplication: y = A * x.
+  vector<T> operator*(const vector<T>& x) const {
+    vector<T> y(_rows);
+    multiply(x, y);
+    return y;
+  }
+
+  /// @brief Converts back to CSR, dropping explicit zeros.
+  sparse_matrix<T> to_csr() const {
+    sparse_builder<T> builder(_rows, _cols);
+    for (size_t br = 0; br + 1 < _block_row_ptr.size(); ++br) {
+      for (size_t k = _block_row_ptr[br]; k < _block_row_ptr[br + 1]; ++k) {
+        for (size_t r = 0; r < _b; ++r) {
+          for (size_t c = 0; c < _b; ++c) {
+            T val = _values[(k * _b + r) * _b + c];
+            if (val != T(0.0)) builder.add(br * _b + r, _block_cols[k] * _b + c, val);
+          }
+        }
+      }
+    }
+    return builder.build();
+  }
+};
+
+/// @brief Sparse matrix in SELL-C-sigma format (sliced ELLPACK).
+/// Rows are sorted by length inside windows of sigma rows, then grouped into chunks of C rows. Every chunk
+/// is padded to its longest row and stored column-major, so the SpMV processes C rows in lockstep: the
+/// inner loop runs over C independent rows and vectorizes, even when rows are short and irregular.
+/// C should match the SIMD width (4 for AVX2 doubles, 8 for AVX-512 doubles or AVX2 floats).
+template <typename T = double, size_t C = 8>
+class sell_matrix {
+  static_assert(std::is_floating_point<T>::value, "numc::sell_matrix supports floating-point types only!");
+  static_assert(C > 0, "SELL chunk height must be positive.");
+
+ private:
+  size_t _rows, _cols, _sigma, _nnz;
+  std::vector<size_t> _chunk_ptr;    // Offset of every chunk in _values / _col_indices.
+  std::vector<size_t> _chunk_width;  // Padded row length of every chunk.
+  std::vector<size_t> _col_indices;  // Padding entries repeat a valid column with a zero value.
+  std::vector<T> _values;
+  std::vector<size_t> _perm;         // _perm[slot] = original row stored in that slot.
+
+  static constexpr size_t _grain = size_t(1) << 15;
+
+  void _multiply_chunks(size_t c0, size_t c1, const T* x, T* y) const {
+    size_t n_slots = _perm.size();
+    for (size_t c = c0; c < c1; ++c) {
+      T acc[C] = {};
+      const T* v = _values.data() + _chunk_ptr[c];
+      const size_t* ci = _col_indices.data() + _chunk_ptr[c];
+      for (size_t k = 0; k < _chunk_width[c]; ++k) {
+        for (size_t r = 0; r < C; ++r) acc[r] += v[k * C + r] * x[ci[k * C + r]];
+      }
+      for (size_t r = 0; r < C && c * C + r < n_slots; ++r) y[_perm[c * C + r]] = acc[r];
+    }
+  }
+
+ public:
+  /// @brief Converts a CSR matrix.
+  /// @param sigma Sorting window in rows. 1 keeps the original order; larger windows reduce padding at the
+  /// cost of less locality in y. Rounded up to a multiple of C.
+  explicit sell_matrix(const sparse_matrix<T>& A, size_t sigma = 32 * C) : _rows(A.rows()), _cols(A.cols()), _nnz(A.nnz()) {
+    _sigma = sigma <= 1 ? 1 : (sigma + C - 1) / C * C;
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    const auto& v = A.values();
+    auto len = [&](size_t i) { return rp[i + 1] - rp[i]; };
+
+    _perm.resize(_rows);
+    std::iota(_perm.begin(), _perm.end(), size_t(0));
+    if (_sigma > 1) {
+      for (size_t s = 0; s < _rows; s += _sigma) {
+        std::stable_sort(_perm.begin() + s, _perm.begin() + std::min(_rows, s + _sigma),
+                         [&](size_t a, size_t b) { return len(a) > len(b); });
+      }
+    }
+
+    size_t n_chunks = (_rows + C - 1) / C;
+    _chunk_ptr.assign(n_chunks + 1, 0);
+    _chunk_width.assign(n_chunks, 0);
+    for (size_t c = 0; c < n_chunks; ++c) {
+      size_t w = 0;
+      for (size_t r = 0; r < C && c * C + r < _rows; ++r) w = std::max(w, len(_perm[c * C + r]));
+      _chunk_width[c] = w;
+      _chunk_ptr[c + 1] = _chunk_ptr[c] + w * C;
+    }
+    _col_indices.assign(_chunk_ptr[n_chunks], 0);
+    _values.assign(_chunk_ptr[n_chunks], T(0.0));
+    utility::parallel_for(0, n_chunks, std::max<size_t>(1, _grain / (C * 8)), [&](size_t lo, size_t hi) {
+      for (size_t c = lo; c < hi; ++c) {
+        for (size_t r = 0; r < C && c * C + r < _rows; ++r) {
+          size_t i = _perm[c * C + r];
+          size_t k = 0;
+          size_t pad_col = len(i) > 0 ? ci[rp[i]] : 0;
+          for (; k < len(i); ++k) {
+            _col_indices[_chunk_ptr[c] + k * C + r] = ci[rp[i] + k];
+            _values[_chunk_ptr[c] + k * C + r] = v[rp[i] + k];
+          }
+          for (; k < _chunk_width[c]; ++k) _col_indices[_chunk_ptr[c] + k * C + r] = pad_col;
+        }
+      }
+    });
+  }
+
+  /// @brief Returns the number of rows.
+  size_t rows() const { return _rows; }
+
+  /// @brief Returns the number of columns.
+  size_t cols() const { return _cols; }
+
+  /// @brief Returns the number of non-zero elements of the original matrix.
+  size_t nnz() const { return _nnz; }
+
+  /// @brief Returns the chunk height C.
+  static constexpr size_t chunk_size() { return C; }
+
+  /// @brief Returns the sorting window sigma.
+  size_t sigma() const { return _sigma; }
+
+  /// @brief Stored entries divided by nonzeros; 1 means no padding at all.
+  double fill_ratio() const { return _nnz == 0 ? 1.0 : static_cast<double>(_values.size()) / static_cast<double>(_nnz); }
+
+  /// @brief SpMV into a caller-provided buffer: y = A * x, in parallel over balanced groups of chunks.
+  /// @throws std::invalid_argument If x has the wrong size.
+  void multiply(const vector<T>& x, vector<T>& y) const {
+    if (x.size() != _cols) {
+      Log::Error("SELL SpMV failed: vector size " + std::to_string(x.size()) + " does not match " + std::to_string(_cols) + " columns.");
+      throw std::invalid_argument("Vector size must match the number of columns for SpMV.");
+    }
+    if (y.size() != _rows) y.resize(_rows);
+    if (_rows == 0) return;
+    const T* xp = x.raw();
+    T* yp = y.raw();
+    size_t n_chunks = _chunk_width.size();
+    size_t blocks = std::max<size_t>(1, std::min(utility::num_threads(), (_rows + _values.size()) / _grain));
+    if (blocks <= 1) {
+      _multiply_chunks(0, n_chunks, xp, yp);
+      return;
+    }
+    utility::thread_pool::instance().run(blocks, [&](size_t p) {
+      _multiply_chunks(utility::weighted_split(_chunk_ptr, p, blocks), utility::weighted_split(_chunk_ptr, p + 1, blocks), xp, yp);
+    });
+  }
+
+  /// @brief Sparse matrix-vector multiplication: y = A * x.
+  vector<T> operator*(const vector<T>& x) const {
+    vector<T> y(_rows);
+    multiply(x, y);
+    return y;
+  }
+};
+
+/// @}
+
+}  // namespace numc
@@ -93,6 +93,10 @@ class tensor {
   /// @return The total element count.
   inline size_t total_size() const { return _data.size(); }
 
+  /// @brief Direct access to the contiguous row-major element storage (no bounds checking).
+  T* raw() { return _data.data(); }
+  const T* raw() const { return _data.data(); }
+
   /// @brief Gets the number of dimensions (rank) of the tensor.
   /// @return The dimension count (e.g., 2 for a matrix).
   inline size_t dimensions() const { return _shape.size(); }
@@ -38,9 +38,21 @@ class vector {
   /// @brief Implicit conversion to std::vector<T>.
   operator std::vector<T>() const { return data; }
 
+  /// @brief Copy and move operations. The moves only hand over the storage, so std::swap and
+  /// std::move of a vector cost O(1).
+  vector(const vector&) = default;
+  vector(vector&&) noexcept = default;
+  vector& operator=(const vector&) = default;
+  vector& operator=(vector&&) noexcept = default;
+
   /// @brief Default destructor.
   ~vector() = default;
 
+  /// @brief Exchanges the storage of two vectors without copying.
+  void swap(vector& other) noexcept { data.swap(other.data); }
+
+  friend void swap(vector& a, vector& b) noexcept { a.swap(b); }
+
   /// @brief Iterator support for range-based for loops.
   auto begin() { return data.begin(); }
   auto end() { return data.end(); }
@@ -66,6 +78,10 @@ class vector {
   /// @return The size of the vector.
   inline size_t size() const { return data.size(); }
 
+  /// @brief Direct access to the contiguous element storage (no bounds checking).
+  T* raw() { return data.data(); }
+  const T* raw() const { return data.data(); }
+
   /// @brief Array subscript operator for element access.
   /// @param index The zero-based index of the element.
   /// @return A reference to the element at the specified index.
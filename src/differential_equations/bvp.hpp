@@ -2,6 +2,7 @@
 
 #include "../common/vector.hpp"
 #include "../common/tensor.hpp"
+#include "../linear_algebra/banded.hpp"
 #include "../linear_algebra/solvers.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
@@ -26,9 +27,7 @@ std::pair<vector<T>, vector<T>> finite_diff_bvp(
   T h = (b - a) / T(n);
 
   // Setup tridiagonal system
-  vector<T> sub(n - 1);
-  vector<T> diag(n - 1);
-  vector<T> sup(n - 1);
+  linear_algebra::banded_matrix<T> A(n - 1, 1, 1);
   vector<T> rhs(n - 1);
 
   for (size_t i = 0; i < n - 1; ++i) {
@@ -37,30 +36,21 @@ std::pair<vector<T>, vector<T>> finite_diff_bvp(
     T qi = q(x);
     T ri = r(x);
 
-    sub[i] = T(1.0) - h * pi / T(2.0);
-    diag[i] = -T(2.0) + h * h * qi;
-    sup[i] = T(1.0) + h * pi / T(2.0);
+    T sub = T(1.0) - h * pi / T(2.0);
+    T sup = T(1.0) + h * pi / T(2.0);
+    A(i, i) = -T(2.0) + h * h * qi;
     rhs[i] = h * h * ri;
-  }
-
-  // Apply boundary conditions
-  rhs[0] -= sub[0] * alpha;
-  rhs[n - 2] -= sup[n - 2] * beta;
 
-  // Solve tridiagonal system (Thomas algorithm)
-  // Forward sweep
-  for (size_t i = 1; i < n - 1; ++i) {
-    T m = sub[i] / diag[i - 1];
-    diag[i] -= m * sup[i - 1];
-    rhs[i] -= m * rhs[i - 1];
-  }
-  // Back substitution
-  vector<T> y_inner(n - 1);
-  y_inner[n - 2] = rhs[n - 2] / diag[n - 2];
-  for (int i = static_cast<int>(n) - 3; i >= 0; --i) {
-    y_inner[i] = (rhs[i] - sup[i] * y_inner[i + 1]) / diag[i];
+    // Apply boundary conditions
+    if (i > 0) A(i, i - 1) = sub;
+    else rhs[i] -= sub * alpha;
+    if (i + 2 < n) A(i, i + 1) = sup;
+    else rhs[i] -= sup * beta;
   }
 
+  // Solve the tridiagonal system (banded LU with partial pivoting)
+  vector<T> y_inner = linear_algebra::banded_lu_factorization<T>(A).solve(rhs);
+
   // Build full solution
   vector<T> x_full(n + 1);
   vector<T> y_full(n + 1);
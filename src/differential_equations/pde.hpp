@@ -2,6 +2,7 @@
 
 #include "../common/vector.hpp"
 #include "../common/tensor.hpp"
+#include "../linear_algebra/tridiagonal.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
 
@@ -45,7 +46,9 @@ std::vector<vector<T>> heat_explicit_1d(
   return result;
 }
 
-/// @brief Solves the 1D heat equation using implicit (BTCS) method with Thomas algorithm.
+/// @brief Solves the 1D heat equation using implicit (BTCS) method. The tridiagonal matrix is the same at
+/// every step, so it is factorized once and each step is two sweeps over the stored factors, done in place
+/// on the interior of the new time level.
 template <typename T = double>
 std::vector<vector<T>> heat_implicit_1d(
     const vector<T>& u0,
@@ -63,33 +66,17 @@ std::vector<vector<T>> heat_implicit_1d(
   vector<T> u = u0;
   result.push_back(u);
 
-  for (size_t t = 0; t < n_steps; ++t) {
-    // Setup tridiagonal system
-    vector<T> a(n), b(n), c(n), d(n);
-    for (size_t i = 0; i < n; ++i) {
-      a[i] = -r;
-      b[i] = T(1.0) + T(2.0) * r;
-      c[i] = -r;
-      d[i] = u[i + 1];
-    }
-    d[0] += r * bc_left;
-    d[n - 1] += r * bc_right;
-
-    // Thomas algorithm
-    for (size_t i = 1; i < n; ++i) {
-      T m = a[i] / b[i - 1];
-      b[i] -= m * c[i - 1];
-      d[i] -= m * d[i - 1];
-    }
-    vector<T> x_sol(n);
-    x_sol[n - 1] = d[n - 1] / b[n - 1];
-    for (int i = static_cast<int>(n) - 2; i >= 0; --i) {
-      x_sol[i] = (d[i] - c[i] * x_sol[i + 1]) / b[i];
-    }
+  // Setup and factorize the tridiagonal system
+  vector<T> off(std::vector<T>(n, -r)), diag(std::vector<T>(n, T(1.0) + T(2.0) * r));
+  linear_algebra::tridiagonal_factorization<T> lu(off, diag, off);
 
-    vector<T> u_new(nx);
+  result.reserve(n_steps + 1);
+  for (size_t t = 0; t < n_steps; ++t) {
+    vector<T> u_new = u;
+    u_new[1] += r * bc_left;
+    u_new[nx - 2] += r * bc_right;
+    lu.solve_in_place(u_new.raw() + 1);
     u_new[0] = bc_left;
-    for (size_t i = 0; i < n; ++i) u_new[i + 1] = x_sol[i];
     u_new[nx - 1] = bc_right;
     u = u_new;
     result.push_back(u);
@@ -0,0 +1,325 @@
+#pragma once
+
+#include "../common/sparse.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "krylov.hpp"
+#include "preconditioners.hpp"
+#include "sparse_direct.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Relaxation used on every level of the multigrid hierarchy.
+enum class amg_smoother {
+  jacobi,                  // Damped Jacobi, fully parallel.
+  gauss_seidel,            // Forward sweep before, backward sweep after the coarse correction (keeps the cycle symmetric).
+  multicolor_gauss_seidel  // Same, with the rows of every color relaxed in parallel (see sparse_matrix::coloring).
+};
+
+/// @brief Settings of the smoothed-aggregation hierarchy.
+template <typename T = double>
+struct amg_options {
+  T strength_threshold = T(0.08);  // Couple i-j is strong if |a_ij| >= theta * sqrt(|a_ii a_jj|).
+  size_t coarse_size = 500;        // Stop coarsening below this many unknowns and solve directly.
+  size_t max_levels = 12;          // Upper bound on the number of levels, including the finest.
+  amg_smoother smoother = amg_smoother::gauss_seidel;
+  int pre_sweeps = 1;              // Smoothing sweeps before the coarse correction.
+  int post_sweeps = 1;             // Smoothing sweeps after the coarse correction.
+};
+
+/// @brief Smoothed-aggregation algebraic multigrid (Vanek, Mandel, Brezina) for symmetric positive
+/// definite sparse systems, e.g. Poisson-type problems.
+///
+/// Setup: strength-of-connection graph, greedy three-phase aggregation, tentative prolongator from the
+/// constant near-null-space vector, prolongator smoothing P = (I - w D^-1 A) P_tent with w = 4 / (3 rho),
+/// and Galerkin coarse operators A_c = P^T A P built with the parallel SpGEMM. The coarsest level is
+/// factorized with sparse_cholesky.
+///
+/// apply() performs one V-cycle from a zero initial guess, so the object plugs straight into pcg() as a
+/// symmetric preconditioner; solve() iterates V-cycles as a standalone solver.
+template <typename T = double>
+class amg_preconditioner : public preconditioner<T> {
+ private:
+  struct level {
+    sparse_matrix<T> A;
+    sparse_matrix<T> P;  // Prolongation from the next coarser level.
+    sparse_matrix<T> R;  // Restriction, P^T stored explicitly for a parallel SpMV.
+    std::vector<size_t> diag;
+    vector<T> inv_diag;
+    T jacobi_weight = T(0.0);
+    sparse_coloring colors;
+    // Work vectors, sized once at setup so a cycle does not allocate.
+    mutable vector<T> x, b, r;
+
+    level(sparse_matrix<T> a) : A(std::move(a)), P(0, 0), R(0, 0) {}
+  };
+
+  std::vector<level> _levels;
+  sparse_cholesky<T> _coarse;
+  amg_options<T> _opt;
+
+  static constexpr size_t _grain = size_t(1) << 15;
+
+  /// @brief Estimates the spectral radius of D^-1 A: a few power iterations, safeguarded by the
+  /// Gershgorin bound max_i sum_j |a_ij| / |a_ii|.
+  static T _spectral_radius(const sparse_matrix<T>& A, const vector<T>& inv_diag) {
+    size_t n = A.rows();
+    const auto& rp = A.row_ptr();
+    const auto& v = A.values();
+    T gershgorin = T(0.0);
+    for (size_t i = 0; i < n; ++i) {
+      T s = T(0.0);
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) s += std::abs(v[k]);
+      gershgorin = std::max(gershgorin, s * std::abs(inv_diag[i]));
+    }
+    vector<T> x(n), y(n);
+    for (size_t i = 0; i < n; ++i) x[i] = T(1.0) + T(i % 7) / T(7.0);
+    T rho = T(0.0);
+    for (int it = 0; it < 15; ++it) {
+      T xn = detail::norm(x);
+      if (xn == T(0.0)) break;
+      for (size_t i = 0; i < n; ++i) x[i] /= xn;
+      A.multiply(x, y);
+      for (size_t i = 0; i < n; ++i) y[i] *= inv_diag[i];
+      rho = detail::norm(y);
+      std::swap(x, y);
+    }
+    return std::min(gershgorin, T(1.1) * rho);
+  }
+
+  /// @brief Greedy aggregation on the strength graph. Returns the aggregate of every node and their count.
+  size_t _aggregate(const sparse_matrix<T>& A, const vector<T>& diag_values, std::vector<size_t>& agg) const {
+    const size_t npos = SIZE_MAX;
+    size_t n = A.rows();
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    const auto& v = A.values();
+    T theta2 = _opt.strength_threshold * _opt.strength_threshold;
+
+    // Strong neighbours, excluding the diagonal.
+    std::vector<size_t> sp(n + 1, 0), sj;
+    sj.reserve(A.nnz());
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+        size_t j = ci[k];
+        if (j != i && v[k] * v[k] >= theta2 * std::abs(diag_values[i] * diag_values[j])) sj.push_back(j);
+      }
+      sp[i + 1] = sj.size();
+    }
+
+    agg.assign(n, npos);
+    size_t count = 0;
+    // Phase 1: a node whose whole strong neighbourhood is free becomes the root of a new aggregate.
+    for (size_t i = 0; i < n; ++i) {
+      if (agg[i] != npos) continue;
+      bool free = true;
+      for (size_t k = sp[i]; k < sp[i + 1] && free; ++k) free = agg[sj[k]] == npos;
+      if (!free) continue;
+      agg[i] = count;
+      for (size_t k = sp[i]; k < sp[i + 1]; ++k) agg[sj[k]] = count;
+      ++count;
+    }
+    // Phase 2: attach leftover nodes to the aggregate of a neighbour from phase 1.
+    std::vector<size_t> phase1 = agg;
+    for (size_t i = 0; i < n; ++i) {
+      if (agg[i] != npos) continue;
+      for (size_t k = sp[i]; k < sp[i + 1]; ++k) {
+        if (phase1[sj[k]] != npos) {
+          agg[i] = phase1[sj[k]];
+          break;
+        }
+      }
+    }
+    // Phase 3: whatever is still free forms aggregates with its free strong neighbours.
+    for (size_t i = 0; i < n; ++i) {
+      if (agg[i] != npos) continue;
+      agg[i] = count;
+      for (size_t k = sp[i]; k < sp[i + 1]; ++k) {
+        if (agg[sj[k]] == npos) agg[sj[k]] = count;
+      }
+      ++count;
+    }
+    return count;
+  }
+
+  void _smooth(const level& L, int sweeps, bool forward) const {
+    T* x = L.x.raw();
+    const T* b = L.b.raw();
+    if (_opt.smoother == amg_smoother::jacobi) {
+      const T* d = L.inv_diag.raw();
+      const T* r = L.r.raw();
+      T w = L.jacobi_weight;
+      for (int s = 0; s < sweeps; ++s) {
+        L.A.multiply(L.x, L.r);
+        utility::parallel_for(0, L.x.size(), _grain, [&](size_t lo, size_t hi) {
+          for (size_t i = lo; i < hi; ++i) x[i] += w * d[i] * (b[i] - r[i]);
+        });
+      }
+      return;
+    }
+    if (_opt.smoother == amg_smoother::multicolor_gauss_seidel) {
+      for (int s = 0; s < sweeps; ++s) L.A.sor_sweep(L.colors, L.b, L.x, T(1.0), forward);
+      return;
+    }
+    const size_t* rp = L.A.row_ptr().data();
+    const size_t* ci = L.A.col_indices().data();
+    const T* v = L.A.values().data();
+    size_t n = L.x.size();
+    auto relax = [&](size_t i) {
+      T sum = b[i];
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) sum -= v[k] * x[ci[k]];
+      x[i] += sum / v[L.diag[i]];
+    };
+    for (int s = 0; s < sweeps; ++s) {
+      if (forward) {
+        for (size_t i = 0; i < n; ++i) relax(i);
+      } else {
+        for (size_t i = n; i-- > 0;) relax(i);
+      }
+    }
+  }
+
+  /// @brief V-cycle on level l for L.x with right-hand side L.b.
+  void _cycle(size_t l) const {
+    const level& L = _levels[l];
+    if (l + 1 == _levels.size()) {
+      _coarse.solve(L.b, L.x, L.r);
+      return;
+    }
+    _smooth(L, _opt.pre_sweeps, true);
+    detail::residual(L.A, L.x, L.b, L.r);
+    const level& C = _levels[l + 1];
+    L.R.multiply(L.r, C.b);
+    std::fill(C.x.raw(), C.x.raw() + C.x.size(), T(0.0));
+    _cycle(l + 1);
+    L.P.multiply(C.x, L.r);
+    detail::axpby(T(1.0), L.r, T(1.0), L.x);
+    _smooth(L, _opt.post_sweeps, false);
+  }
+
+ public:
+  /// @brief Builds the multigrid hierarchy.
+  /// @param A Symmetric positive definite matrix with a positive diagonal. It is copied into the finest level.
+  /// @throws std::invalid_argument If A is not square.
+  /// @throws std::domain_error If A has a zero diagonal entry or the coarse matrix is not positive definite.
+  explicit amg_preconditioner(const sparse_matrix<T>& A, const amg_options<T>& options = amg_options<T>()) : _opt(options) {
+    _levels.emplace_back(A);
+    while (true) {
+      level& L = _levels.back();
+      size_t n = L.A.rows();
+      L.diag = diagonal_positions(L.A);
+      L.inv_diag = vector<T>(n);
+      vector<T> dv(n);
+      for (size_t i = 0; i < n; ++i) {
+        dv[i] = L.A.values()[L.diag[i]];
+        L.inv_diag[i] = T(1.0) / dv[i];
+      }
+      L.x = vector<T>(n);
+      L.b = vector<T>(n);
+      L.r = vector<T>(n);
+      if (_opt.smoother == amg_smoother::multicolor_gauss_seidel) L.colors = L.A.coloring();
+      if (n <= _opt.coarse_size || _levels.size() >= _opt.max_levels) break;
+
+      T rho = _spectral_radius(L.A, L.inv_diag);
+      L.jacobi_weight = T(4.0) / (T(3.0) * rho);
+
+      std::vector<size_t> agg;
+      size_t nc = _aggregate(L.A, dv, agg);
+      if (nc == n || nc == 0) break;  // no coarsening possible (e.g. a diagonal matrix)
+
+      // Tentative prolongator: normalized indicator of every aggregate.
+      std::vector<size_t> size(nc, 0);
+      for (size_t i = 0; i < n; ++i) ++size[agg[i]];
+      std::vector<size_t> t_ptr(n + 1), t_col(agg);
+      std::vector<T> t_val(n);
+      for (size_t i = 0; i < n; ++i) {
+        t_ptr[i + 1] = i + 1;
+        t_val[i] = T(1.0) / std::sqrt(T(size[agg[i]]));
+      }
+      auto tentative = sparse_matrix<T>::from_csr(n, nc, std::move(t_ptr), std::move(t_col), std::move(t_val));
+
+      // P = (I - w D^-1 A) P_tent
+      sparse_matrix<T> DinvA = L.A;
+      const auto& rp = DinvA.row_ptr();
+      auto& dav = DinvA.values();
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t k = rp[i]; k < rp[i + 1]; ++k) dav[k] *= L.inv_diag[i];
+      }
+      L.P = tentative - DinvA.matmul(tentative) * L.jacobi_weight;
+      L.R = L.P.transpose();
+      sparse_matrix<T> Ac = L.R.matmul(L.A.matmul(L.P));
+      _levels.emplace_back(std::move(Ac));
+    }
+    level& L = _levels.back();
+    if (L.jacobi_weight == T(0.0)) L.jacobi_weight = T(4.0) / (T(3.0) * _spectral_radius(L.A, L.inv_diag));
+    _coarse.analyze(L.A);
+    _coarse.factorize(L.A);
+  }
+
+  /// @brief One V-cycle applied to r from a zero initial guess: z ~ A^-1 r.
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    const level& L = _levels[0];
+    std::copy(r.raw(), r.raw() + r.size(), L.b.raw());
+    std::fill(L.x.raw(), L.x.raw() + L.x.size(), T(0.0));
+    _cycle(0);
+    std::copy(L.x.raw(), L.x.raw() + L.x.size(), z.raw());
+  }
+
+  /// @brief Standalone solver: repeats V-cycles until ||b - A x|| <= tol * ||b||.
+  /// @throws std::invalid_argument If b has the wrong size.
+  krylov_result<T> solve(const vector<T>& b, T tol = T(1e-8), int max_iter = 200) const {
+    const level& L = _levels[0];
+    detail::check_system(L.A, b, "AMG solve");
+    krylov_result<T> res;
+    size_t n = b.size();
+    res.x = vector<T>(n);
+    T b_norm = detail::norm(b);
+    if (b_norm == T(0.0)) {
+      res.converged = true;
+      res.residuals.push_back(T(0.0));
+      return res;
+    }
+    res.residuals.push_back(T(1.0));
+    vector<T> r = b;
+    for (int it = 0; it < max_iter; ++it) {
+      std::copy(res.x.raw(), res.x.raw() + n, L.x.raw());
+      std::copy(b.raw(), b.raw() + n, L.b.raw());
+      _cycle(0);
+      std::copy(L.x.raw(), L.x.raw() + n, res.x.raw());
+      detail::residual(L.A, res.x, b, r);
+      T rel = detail::norm(r) / b_norm;
+      res.iterations = it + 1;
+      res.residuals.push_back(rel);
+      if (rel <= tol) {
+        res.converged = true;
+        return res;
+      }
+    }
+    Log::Warn("AMG V-cycle iteration did not converge.");
+    return res;
+  }
+
+  /// @brief Number of levels in the hierarchy, including the finest.
+  size_t levels() const { return _levels.size(); }
+
+  /// @brief Number of unknowns on level l (0 is the finest).
+  size_t level_size(size_t l) const { return _levels.at(l).A.rows(); }
+
+  /// @brief Sum of nonzeros over all levels divided by the nonzeros of the finest matrix.
+  double operator_complexity() const {
+    double total = 0.0;
+    for (const auto& L : _levels) total += static_cast<double>(L.A.nnz());
+    return total / static_cast<double>(_levels[0].A.nnz());
+  }
+};
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
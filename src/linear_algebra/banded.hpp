@@ -0,0 +1,415 @@
+#pragma once
+
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "factorizations.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Square band matrix with kl sub-diagonals and ku super-diagonals in LAPACK general band storage:
+/// column-major, (kl + ku + 1) x n, with A(i, j) at row ku + i - j of column j. Every column of the band
+/// is contiguous, which is what the column-oriented band LU and Cholesky kernels below stream through.
+template <typename T = double>
+class banded_matrix {
+  static_assert(std::is_floating_point<T>::value, "numc::banded_matrix supports floating-point types only!");
+
+ private:
+  size_t _n = 0;
+  size_t _kl = 0;
+  size_t _ku = 0;
+  std::vector<T> _ab;
+
+ public:
+  banded_matrix() = default;
+
+  /// @brief Zero n x n band matrix with kl sub-diagonals and ku super-diagonals.
+  banded_matrix(size_t n, size_t kl, size_t ku) : _n(n), _kl(kl), _ku(ku), _ab((kl + ku + 1) * n, T(0.0)) {}
+
+  /// @brief Tridiagonal matrix from its diagonals: sub[i] = A(i + 1, i), diag[i] = A(i, i), sup[i] = A(i, i + 1).
+  /// @throws std::invalid_argument If sub or sup does not have diag.size() - 1 entries (extra entries are ignored).
+  static banded_matrix tridiagonal(const vector<T>& sub, const vector<T>& diag, const vector<T>& sup) {
+    size_t n = diag.size();
+    if (n > 0 && (sub.size() + 1 < n || sup.size() + 1 < n)) {
+      Log::Error("banded_matrix::tridiagonal failed: off-diagonals must have n - 1 entries.");
+      throw std::invalid_argument("Off-diagonal size does not match the diagonal.");
+    }
+    banded_matrix res(n, 1, 1);
+    for (size_t i = 0; i < n; ++i) {
+      res._ab[i * 3 + 1] = diag[i];
+      if (i + 1 < n) {
+        res._ab[i * 3 + 2] = sub[i];
+        res._ab[(i + 1) * 3] = sup[i];
+      }
+    }
+    return res;
+  }
+
+  size_t size() const { return _n; }
+  size_t lower() const { return _kl; }
+  size_t upper() const { return _ku; }
+
+  /// @brief Leading dimension of the band storage, kl + ku + 1.
+  size_t ld() const { return _kl + _ku + 1; }
+
+  /// @brief Raw band storage (see the class description).
+  const std::vector<T>& data() const { return _ab; }
+
+  bool in_band(size_t i, size_t j) const { return i < _n && j < _n && i <= j + _kl && j <= i + _ku; }
+
+  /// @brief Reference to A(i, j).
+  /// @throws std::out_of_range If (i, j) lies outside the band.
+  T& operator()(size_t i, size_t j) {
+    if (!in_band(i, j)) {
+      Log::Error("banded_matrix index (" + std::to_string(i) + ", " + std::to_string(j) + ") is outside the band.");
+      throw std::out_of_range("Banded matrix index outside the band.");
+    }
+    return _ab[j * ld() + _ku + i - j];
+  }
+
+  /// @brief A(i, j); zero outside the band.
+  T operator()(size_t i, size_t j) const { return in_band(i, j) ? _ab[j * ld() + _ku + i - j] : T(0.0); }
+
+  /// @brief y = Ax, O(n (kl + ku)).
+  vector<T> operator*(const vector<T>& x) const {
+    if (x.size() != _n) {
+      Log::Error("banded_matrix product failed: vector has size " + std::to_string(x.size()) + ", expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Vector size does not match the matrix.");
+    }
+    vector<T> y(_n);
+    size_t l = ld();
+    for (size_t j = 0; j < _n; ++j) {
+      const T* col = _ab.data() + j * l + _ku - j;
+      T xj = x[j];
+      size_t i0 = j > _ku ? j - _ku : 0, i1 = std::min(_n, j + _kl + 1);
+      for (size_t i = i0; i < i1; ++i) y[i] += col[i] * xj;
+    }
+    return y;
+  }
+
+  /// @brief Dense copy of the matrix.
+  tensor<T> to_dense() const {
+    tensor<T> res({_n, _n});
+    for (size_t j = 0; j < _n; ++j) {
+      size_t i0 = j > _ku ? j - _ku : 0, i1 = std::min(_n, j + _kl + 1);
+      for (size_t i = i0; i < i1; ++i) res.raw()[i * _n + j] = (*this)(i, j);
+    }
+    return res;
+  }
+};
+
+/// @brief LU factorization with partial pivoting of a band matrix (LAPACK gbtrf/gbtrs). Row interchanges
+/// widen U to kl + ku super-diagonals, so the factors are kept in a (2 kl + ku + 1) x n band; the cost is
+/// O(n kl (kl + ku)) instead of O(n^3), and each solve is O(n (2 kl + ku)) per right-hand side.
+template <typename T = double>
+class banded_lu_factorization {
+ private:
+  std::vector<T> _ab;
+  std::vector<size_t> _piv;
+  size_t _n = 0;
+  size_t _kl = 0;
+  size_t _ku = 0;
+  T _anorm = T(0.0);
+
+  size_t _ld() const { return 2 * _kl + _ku + 1; }
+
+  // Entry (i, j) of the factor storage; row offset kv = kl + ku puts the diagonal at row kv of each column.
+  T& _at(size_t i, size_t j) { return _ab[j * _ld() + _kl + _ku + i - j]; }
+  T _at(size_t i, size_t j) const { return _ab[j * _ld() + _kl + _ku + i - j]; }
+
+  void _check_rhs(size_t rows) const {
+    if (rows != _n) {
+      Log::Error("Banded LU solve failed: right-hand side has " + std::to_string(rows) + " rows, expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Right-hand side size does not match the factorization.");
+    }
+  }
+
+  // Solves with k right-hand sides stored row-major (n x k), one row operation per band entry.
+  void _solve(T* b, size_t k) const {
+    size_t kv = _kl + _ku;
+    for (size_t j = 0; j + 1 < _n; ++j) {
+      T* bj = b + j * k;
+      if (_piv[j] != j) std::swap_ranges(bj, bj + k, b + _piv[j] * k);
+      size_t km = std::min(_kl, _n - 1 - j);
+      for (size_t r = 1; r <= km; ++r) {
+        T l = _at(j + r, j);
+        if (l == T(0.0)) continue;
+        T* br = b + (j + r) * k;
+        for (size_t c = 0; c < k; ++c) br[c] -= l * bj[c];
+      }
+    }
+    for (size_t j = _n; j-- > 0;) {
+      T* bj = b + j * k;
+      T inv = T(1.0) / _at(j, j);
+      for (size_t c = 0; c < k; ++c) bj[c] *= inv;
+      for (size_t i = j > kv ? j - kv : 0; i < j; ++i) {
+        T u = _at(i, j);
+        if (u == T(0.0)) continue;
+        T* bi = b + i * k;
+        for (size_t c = 0; c < k; ++c) bi[c] -= u * bj[c];
+      }
+    }
+  }
+
+  // Solves A^T x = b for one right-hand side (used by the condition estimator).
+  void _solve_transpose(T* b) const {
+    size_t kv = _kl + _ku;
+    for (size_t j = 0; j < _n; ++j) {
+      T sum = b[j];
+      for (size_t i = j > kv ? j - kv : 0; i < j; ++i) sum -= _at(i, j) * b[i];
+      b[j] = sum / _at(j, j);
+    }
+    for (size_t j = _n - 1; j-- > 0;) {
+      size_t km = std::min(_kl, _n - 1 - j);
+      T sum = b[j];
+      for (size_t r = 1; r <= km; ++r) sum -= _at(j + r, j) * b[j + r];
+      b[j] = sum;
+      if (_piv[j] != j) std::swap(b[j], b[_piv[j]]);
+    }
+  }
+
+ public:
+  banded_lu_factorization() = default;
+
+  /// @brief Factorizes a.
+  /// @throws std::runtime_error If a is singular.
+  explicit banded_lu_factorization(const banded_matrix<T>& a) { factorize(a); }
+
+  /// @brief Factorizes a, reusing the storage of the previous factorization when the size and bandwidths match.
+  void factorize(const banded_matrix<T>& a) {
+    _n = a.size();
+    _kl = a.lower();
+    _ku = a.upper();
+    size_t ld = _ld(), lda = a.ld();
+    _ab.assign(ld * _n, T(0.0));
+    _piv.resize(_n);
+    _anorm = T(0.0);
+    for (size_t j = 0; j < _n; ++j) {
+      const T* src = a.data().data() + j * lda;
+      std::copy(src, src + lda, _ab.data() + j * ld + _kl);
+      T sum = T(0.0);
+      for (size_t r = 0; r < lda; ++r) sum += std::abs(src[r]);
+      _anorm = std::max(_anorm, sum);
+    }
+
+    size_t kv = _kl + _ku, ju = 0;
+    for (size_t j = 0; j < _n; ++j) {
+      size_t km = std::min(_kl, _n - 1 - j);
+      size_t p = 0;
+      T best = std::abs(_at(j, j));
+      for (size_t r = 1; r <= km; ++r) {
+        if (std::abs(_at(j + r, j)) > best) {
+          best = std::abs(_at(j + r, j));
+          p = r;
+        }
+      }
+      _piv[j] = j + p;
+      if (best == T(0.0)) {
+        Log::Error("Banded LU factorization failed: matrix is singular (zero pivot in column " + std::to_string(j) + ").");
+        throw std::runtime_error("Matrix is singular.");
+      }
+      ju = std::max(ju, std::min(j + _ku + p, _n - 1));
+      if (p != 0) {
+        for (size_t c = j; c <= ju; ++c) std::swap(_at(j, c), _at(j + p, c));
+      }
+      T inv = T(1.0) / _at(j, j);
+      T* lcol = _ab.data() + j * _ld() + kv + 1;  // L(j + 1 .. j + km, j)
+      for (size_t r = 0; r < km; ++r) lcol[r] *= inv;
+      for (size_t c = j + 1; c <= ju; ++c) {
+        T u = _at(j, c);
+        if (u == T(0.0)) continue;
+        T* col = _ab.data() + c * _ld() + kv + j + 1 - c;
+        for (size_t r = 0; r < km; ++r) col[r] -= lcol[r] * u;
+      }
+    }
+  }
+
+  size_t size() const { return _n; }
+
+  /// @brief Row interchanges: row j was swapped with row pivots()[j] at step j.
+  const std::vector<size_t>& pivots() const { return _piv; }
+
+  /// @brief Solves Ax = b.
+  /// @throws std::invalid_argument If b has the wrong size.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rhs(b.size());
+    vector<T> x = b;
+    _solve(x.raw(), 1);
+    return x;
+  }
+
+  /// @brief Solves AX = B for all columns of B (n x k) in one pass over the factors.
+  /// @throws std::invalid_argument If B does not have n rows.
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("Banded LU solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    _check_rhs(b.shape()[0]);
+    tensor<T> x = b;
+    _solve(x.raw(), b.shape()[1]);
+    return x;
+  }
+
+  /// @brief Determinant of A: the product of the pivots, with the sign of the row permutation.
+  T det() const {
+    T d = T(1.0);
+    for (size_t j = 0; j < _n; ++j) {
+      d *= _at(j, j);
+      if (_piv[j] != j) d = -d;
+    }
+    return d;
+  }
+
+  /// @brief Estimate of the reciprocal 1-norm condition number, from a few band solves (see detail::norm1_estimate).
+  T rcond() const {
+    if (_n == 0) return T(1.0);
+    if (_anorm == T(0.0)) return T(0.0);
+    T inv = detail::norm1_estimate<T>(_n, [&](T* x, bool transpose) {
+      if (transpose) _solve_transpose(x);
+      else _solve(x, 1);
+    });
+    return T(1.0) / (_anorm * inv);
+  }
+};
+
+/// @brief Cholesky factorization A = LL^T of a symmetric positive definite band matrix with kd = kl
+/// sub-diagonals (LAPACK pbtrf/pbtrs); only the lower band of the input is read. No pivoting is
+/// needed, so L keeps the bandwidth of A: O(n kd^2) to factorize, O(n kd) per right-hand side.
+template <typename T = double>
+class banded_cholesky_factorization {
+ private:
+  std::vector<T> _lb;
+  size_t _n = 0;
+  size_t _kd = 0;
+  T _anorm = T(0.0);
+
+  // L(i, j), i - j <= kd, at row i - j of column j of a (kd + 1) x n column-major band.
+  T& _at(size_t i, size_t j) { return _lb[j * (_kd + 1) + i - j]; }
+  T _at(size_t i, size_t j) const { return _lb[j * (_kd + 1) + i - j]; }
+
+  void _check_rhs(size_t rows) const {
+    if (rows != _n) {
+      Log::Error("Banded Cholesky solve failed: right-hand side has " + std::to_string(rows) + " rows, expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Right-hand side size does not match the factorization.");
+    }
+  }
+
+  void _solve(T* b, size_t k) const {
+    for (size_t j = 0; j < _n; ++j) {
+      T* bj = b + j * k;
+      T inv = T(1.0) / _at(j, j);
+      for (size_t c = 0; c < k; ++c) bj[c] *= inv;
+      size_t km = std::min(_kd, _n - 1 - j);
+      for (size_t r = 1; r <= km; ++r) {
+        T l = _at(j + r, j);
+        T* br = b + (j + r) * k;
+        for (size_t c = 0; c < k; ++c) br[c] -= l * bj[c];
+      }
+    }
+    for (size_t j = _n; j-- > 0;) {
+      T* bj = b + j * k;
+      size_t km = std::min(_kd, _n - 1 - j);
+      for (size_t r = 1; r <= km; ++r) {
+        T l = _at(j + r, j);
+        const T* br = b + (j + r) * k;
+        for (size_t c = 0; c < k; ++c) bj[c] -= l * br[c];
+      }
+      T inv = T(1.0) / _at(j, j);
+      for (size_t c = 0; c < k; ++c) bj[c] *= inv;
+    }
+  }
+
+ public:
+  banded_cholesky_factorization() = default;
+
+  /// @brief Factorizes a.
+  /// @throws std::domain_error If a is not positive definite.
+  explicit banded_cholesky_factorization(const banded_matrix<T>& a) { factorize(a); }
+
+  /// @brief Factorizes a, reusing the storage of the previous factorization when the size and bandwidth match.
+  void factorize(const banded_matrix<T>& a) {
+    _n = a.size();
+    _kd = a.lower();
+    _lb.assign((_kd + 1) * _n, T(0.0));
+    std::vector<T> sums(_n, T(0.0));
+    for (size_t j = 0; j < _n; ++j) {
+      size_t km = std::min(_kd, _n - 1 - j);
+      for (size_t r = 0; r <= km; ++r) {
+        T v = a(j + r, j);
+        _at(j + r, j) = v;
+        sums[j] += std::abs(v);
+        if (r > 0) sums[j + r] += std::abs(v);
+      }
+    }
+    _anorm = T(0.0);
+    for (T v : sums) _anorm = std::max(_anorm, v);
+
+    for (size_t j = 0; j < _n; ++j) {
+      T ajj = _at(j, j);
+      if (!(ajj > T(0.0))) {
+        Log::Error("Banded Cholesky decomposition failed: Matrix is not positive definite.");
+        throw std::domain_error("Matrix is not positive definite.");
+      }
+      ajj = std::sqrt(ajj);
+      _at(j, j) = ajj;
+      size_t km = std::min(_kd, _n - 1 - j);
+      T* lcol = _lb.data() + j * (_kd + 1) + 1;
+      for (size_t r = 0; r < km; ++r) lcol[r] /= ajj;
+      for (size_t c = 1; c <= km; ++c) {
+        T lc = lcol[c - 1];
+        T* col = _lb.data() + (j + c) * (_kd + 1);
+        for (size_t r = c; r <= km; ++r) col[r - c] -= lcol[r - 1] * lc;
+      }
+    }
+  }
+
+  size_t size() const { return _n; }
+
+  /// @brief Solves Ax = b.
+  /// @throws std::invalid_argument If b has the wrong size.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rhs(b.size());
+    vector<T> x = b;
+    _solve(x.raw(), 1);
+    return x;
+  }
+
+  /// @brief Solves AX = B for all columns of B (n x k) in one pass over the factor.
+  /// @throws std::invalid_argument If B does not have n rows.
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("Banded Cholesky solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    _check_rhs(b.shape()[0]);
+    tensor<T> x = b;
+    _solve(x.raw(), b.shape()[1]);
+    return x;
+  }
+
+  /// @brief Determinant of A, the squared product of the diagonal of L.
+  T det() const {
+    T d = T(1.0);
+    for (size_t j = 0; j < _n; ++j) d *= _at(j, j);
+    return d * d;
+  }
+
+  /// @brief Estimate of the reciprocal 1-norm condition number (A^-1 is symmetric, so one solve per product).
+  T rcond() const {
+    if (_n == 0) return T(1.0);
+    if (_anorm == T(0.0)) return T(0.0);
+    T inv = detail::norm1_estimate<T>(_n, [&](T* x, bool) { _solve(x, 1); });
+    return T(1.0) / (_anorm * inv);
+  }
+};
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
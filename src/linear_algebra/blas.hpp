@@ -0,0 +1,274 @@
+#pragma once
+
+#include "../inc.hpp"
+#include "../utility/parallel.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Dense kernels on raw row-major storage, in the spirit of BLAS level 3. Matrices are passed as a
+/// pointer to the first element and a leading dimension (distance between consecutive rows), so blocks of
+/// a larger tensor can be used in place. The blocked factorizations are built on top of these.
+namespace blas {
+
+/// @brief Whether an operand is used as stored or transposed.
+enum class op { none, transpose };
+
+/// @brief Which triangle of a matrix holds the data.
+enum class uplo { lower, upper };
+
+/// @brief Whether a triangular matrix has an implicit unit diagonal.
+enum class diag { non_unit, unit };
+
+namespace detail {
+
+// Register block of the micro-kernel and cache blocks (A block in L2, B panel in L3).
+constexpr size_t MR = 4;
+constexpr size_t NR = 8;
+constexpr size_t MC = 128;
+constexpr size_t KC = 256;
+constexpr size_t NC = 4096;
+constexpr size_t TRSM_NB = 64;
+
+/// @brief Pointer to element (i, j) of op(A).
+template <typename T>
+inline const T* at(op t, const T* A, size_t lda, size_t i, size_t j) {
+  return t == op::none ? A + i * lda + j : A + j * lda + i;
+}
+
+/// @brief Packs rows [i0, i0 + mc) x columns [p0, p0 + kc) of op(A) into MR-row slivers, zero padded.
+template <typename T>
+void pack_a(op ta, const T* A, size_t lda, size_t i0, size_t p0, size_t mc, size_t kc, T* buf) {
+  for (size_t ir = 0; ir < mc; ir += MR, buf += MR * kc) {
+    size_t mr = std::min(MR, mc - ir);
+    for (size_t r = 0; r < MR; ++r) {
+      if (r >= mr) {
+        for (size_t k = 0; k < kc; ++k) buf[k * MR + r] = T(0.0);
+      } else if (ta == op::none) {
+        const T* src = A + (i0 + ir + r) * lda + p0;
+        for (size_t k = 0; k < kc; ++k) buf[k * MR + r] = src[k];
+      } else {
+        const T* src = A + p0 * lda + i0 + ir + r;
+        for (size_t k = 0; k < kc; ++k) buf[k * MR + r] = src[k * lda];
+      }
+    }
+  }
+}
+
+/// @brief Packs rows [p0, p0 + kc) x columns [j0, j0 + nc) of op(B) into NR-column slivers, zero padded.
+template <typename T>
+void pack_b(op tb, const T* B, size_t ldb, size_t p0, size_t j0, size_t kc, size_t nc, T* buf) {
+  for (size_t jr = 0; jr < nc; jr += NR, buf += NR * kc) {
+    size_t nr = std::min(NR, nc - jr);
+    for (size_t k = 0; k < kc; ++k) {
+      T* dst = buf + k * NR;
+      if (tb == op::none) {
+        const T* src = B + (p0 + k) * ldb + j0 + jr;
+        for (size_t c = 0; c < nr; ++c) dst[c] = src[c];
+      } else {
+        const T* src = B + (j0 + jr) * ldb + p0 + k;
+        for (size_t c = 0; c < nr; ++c) dst[c] = src[c * ldb];
+      }
+      for (size_t c = nr; c < NR; ++c) dst[c] = T(0.0);
+    }
+  }
+}
+
+/// @brief C[0:mr, 0:nr] += alpha * (packed A sliver) * (packed B sliver).
+template <typename T>
+inline void micro_kernel(size_t kc, const T* a, const T* b, T alpha, T* C, size_t ldc, size_t mr, size_t nr) {
+  T acc[MR][NR] = {};
+  for (size_t k = 0; k < kc; ++k, a += MR, b += NR) {
+    for (size_t r = 0; r < MR; ++r) {
+      T ar = a[r];
+      for (size_t c = 0; c < NR; ++c) acc[r][c] += ar * b[c];
+    }
+  }
+  for (size_t r = 0; r < mr; ++r) {
+    T* crow = C + r * ldc;
+    for (size_t c = 0; c < nr; ++c) crow[c] += alpha * acc[r][c];
+  }
+}
+
+}  // namespace detail
+
+/// @brief C = alpha * op(A) * op(B) + beta * C, with op(A) m x k, op(B) k x n and C m x n.
+/// Operands are packed into cache-sized blocks and multiplied by a register-blocked micro-kernel;
+/// independent blocks of C are distributed over the thread pool.
+template <typename T>
+void gemm(op ta, op tb, size_t m, size_t n, size_t k, T alpha, const T* A, size_t lda, const T* B, size_t ldb, T beta, T* C,
+          size_t ldc) {
+  if (m == 0 || n == 0) return;
+  if (beta != T(1.0)) {
+    for (size_t i = 0; i < m; ++i) {
+      T* crow = C + i * ldc;
+      if (beta == T(0.0)) std::fill(crow, crow + n, T(0.0));
+      else for (size_t j = 0; j < n; ++j) crow[j] *= beta;
+    }
+  }
+  if (k == 0 || alpha == T(0.0)) return;
+
+  using namespace detail;
+  std::vector<T> bbuf(((std::min(n, NC) + NR - 1) / NR) * NR * std::min(k, KC));
+  for (size_t jc = 0; jc < n; jc += NC) {
+    size_t nc = std::min(NC, n - jc);
+    size_t panels = (nc + NR - 1) / NR;
+    for (size_t pc = 0; pc < k; pc += KC) {
+      size_t kc = std::min(KC, k - pc);
+      utility::parallel_for(0, panels, std::max<size_t>(1, 4096 / kc), [&](size_t lo, size_t hi) {
+        pack_b(tb, B, ldb, pc, jc + lo * NR, kc, std::min(nc, hi * NR) - lo * NR, bbuf.data() + lo * NR * kc);
+      });
+
+      // Tasks are (row block, column range) pairs; narrow C is split along columns too.
+      size_t row_blocks = (m + MC - 1) / MC;
+      size_t threads = utility::num_threads();
+      size_t col_parts = std::min(panels, std::max<size_t>(1, (2 * threads + row_blocks - 1) / row_blocks));
+      size_t tasks = row_blocks * col_parts;
+      if (static_cast<double>(m) * nc * kc < 32768.0) tasks = 1, row_blocks = 1, col_parts = 1;
+      auto task = [&](size_t t) {
+        size_t rb = t / col_parts, cp = t % col_parts;
+        size_t i_lo = row_blocks == 1 ? 0 : rb * MC, i_hi = row_blocks == 1 ? m : std::min(m, i_lo + MC);
+        size_t p_lo = panels * cp / col_parts, p_hi = panels * (cp + 1) / col_parts;
+        std::vector<T> abuf(MC * kc + MR * kc);
+        for (size_t ic = i_lo; ic < i_hi; ic += MC) {
+          size_t mc = std::min(MC, i_hi - ic);
+          pack_a(ta, A, lda, ic, pc, mc, kc, abuf.data());
+          for (size_t jp = p_lo; jp < p_hi; ++jp) {
+            size_t jr = jp * NR, nr = std::min(NR, nc - jr);
+            const T* bp = bbuf.data() + jp * NR * kc;
+            for (size_t ir = 0; ir < mc; ir += MR) {
+              micro_kernel(kc, abuf.data() + ir * kc, bp, alpha, C + (ic + ir) * ldc + jc + jr, ldc, std::min(MR, mc - ir), nr);
+            }
+          }
+        }
+      };
+      utility::thread_pool::instance().run(tasks, task);
+    }
+  }
+}
+
+/// @brief Solves op(A) X = alpha * B for X, where A is an m x m triangular matrix and B (m x n) holds
+/// several right-hand sides; B is overwritten with X. Diagonal blocks are solved directly, column chunks
+/// of B in parallel, and the remaining rows are updated with gemm.
+template <typename T>
+void trsm_left(uplo ul, op ta, diag dg, size_t m, size_t n, T alpha, const T* A, size_t lda, T* B, size_t ldb) {
+  if (m == 0 || n == 0) return;
+  if (alpha != T(1.0)) {
+    for (size_t i = 0; i < m; ++i) {
+      for (size_t j = 0; j < n; ++j) B[i * ldb + j] *= alpha;
+    }
+  }
+  using detail::at;
+  // op(A) is lower triangular exactly when (A lower, no transpose) or (A upper, transposed).
+  bool forward = (ul == uplo::lower) == (ta == op::none);
+  size_t nb = detail::TRSM_NB;
+  auto solve_block = [&](size_t i0, size_t ib) {
+    utility::parallel_for(0, n, std::max<size_t>(64, 16384 / (ib * ib + 1)), [&](size_t lo, size_t hi) {
+      for (size_t s = 0; s < ib; ++s) {
+        size_t i = forward ? i0 + s : i0 + ib - 1 - s;
+        T* bi = B + i * ldb;
+        size_t j_lo = forward ? i0 : i + 1, j_hi = forward ? i : i0 + ib;
+        for (size_t j = j_lo; j < j_hi; ++j) {
+          T a = *at(ta, A, lda, i, j);
+          if (a == T(0.0)) continue;
+          const T* bj = B + j * ldb;
+          for (size_t c = lo; c < hi; ++c) bi[c] -= a * bj[c];
+        }
+        if (dg == diag::non_unit) {
+          T d = *at(ta, A, lda, i, i);
+          for (size_t c = lo; c < hi; ++c) bi[c] /= d;
+        }
+      }
+    });
+  };
+  if (forward) {
+    for (size_t i0 = 0; i0 < m; i0 += nb) {
+      size_t ib = std::min(nb, m - i0);
+      solve_block(i0, ib);
+      size_t rest = m - i0 - ib;
+      if (rest) gemm(ta, op::none, rest, n, ib, T(-1.0), at(ta, A, lda, i0 + ib, i0), lda, B + i0 * ldb, ldb, T(1.0), B + (i0 + ib) * ldb, ldb);
+    }
+  } else {
+    for (size_t end = m; end > 0;) {
+      size_t ib = std::min(nb, end), i0 = end - ib;
+      solve_block(i0, ib);
+      if (i0) gemm(ta, op::none, i0, n, ib, T(-1.0), at(ta, A, lda, 0, i0), lda, B + i0 * ldb, ldb, T(1.0), B, ldb);
+      end = i0;
+    }
+  }
+}
+
+/// @brief Solves X op(A) = alpha * B for X, where A is an n x n triangular matrix and B (m x n) holds one
+/// right-hand side per row; B is overwritten with X. Rows are independent and solved in parallel within
+/// each diagonal block; the remaining columns are updated with gemm.
+template <typename T>
+void trsm_right(uplo ul, op ta, diag dg, size_t m, size_t n, T alpha, const T* A, size_t lda, T* B, size_t ldb) {
+  if (m == 0 || n == 0) return;
+  if (alpha != T(1.0)) {
+    for (size_t i = 0; i < m; ++i) {
+      for (size_t j = 0; j < n; ++j) B[i * ldb + j] *= alpha;
+    }
+  }
+  using detail::at;
+  // x op(A) = b runs over the columns left to right exactly when op(A) is upper triangular.
+  bool forward = (ul == uplo::upper) == (ta == op::none);
+  size_t nb = detail::TRSM_NB;
+  auto solve_block = [&](size_t j0, size_t jb) {
+    utility::parallel_for(0, m, std::max<size_t>(16, 16384 / (jb * jb + 1)), [&](size_t lo, size_t hi) {
+      for (size_t r = lo; r < hi; ++r) {
+        T* x = B + r * ldb;
+        for (size_t s = 0; s < jb; ++s) {
+          size_t j = forward ? j0 + s : j0 + jb - 1 - s;
+          size_t i_lo = forward ? j0 : j + 1, i_hi = forward ? j : j0 + jb;
+          T sum = x[j];
+          for (size_t i = i_lo; i < i_hi; ++i) sum -= x[i] * *at(ta, A, lda, i, j);
+          x[j] = dg == diag::unit ? sum : sum / *at(ta, A, lda, j, j);
+        }
+      }
+    });
+  };
+  if (forward) {
+    for (size_t j0 = 0; j0 < n; j0 += nb) {
+      size_t jb = std::min(nb, n - j0);
+      solve_block(j0, jb);
+      size_t rest = n - j0 - jb;
+      if (rest) gemm(op::none, ta, m, rest, jb, T(-1.0), B + j0, ldb, at(ta, A, lda, j0, j0 + jb), lda, T(1.0), B + j0 + jb, ldb);
+    }
+  } else {
+    for (size_t end = n; end > 0;) {
+      size_t jb = std::min(nb, end), j0 = end - jb;
+      solve_block(j0, jb);
+      if (j0) gemm(op::none, ta, m, j0, jb, T(-1.0), B + j0, ldb, at(ta, A, lda, j0, 0), lda, T(1.0), B, ldb);
+      end = j0;
+    }
+  }
+}
+
+/// @brief C = alpha * A A^T + beta * C for the lower triangle of the n x n matrix C, with A n x k.
+/// The strictly upper triangle of C is not referenced. Blocks below the diagonal go through gemm.
+template <typename T>
+void syrk_lower(size_t n, size_t k, T alpha, const T* A, size_t lda, T beta, T* C, size_t ldc) {
+  size_t nb = detail::MC;
+  std::vector<T> diag_block;
+  for (size_t j0 = 0; j0 < n; j0 += nb) {
+    size_t jb = std::min(nb, n - j0);
+    diag_block.assign(jb * jb, T(0.0));
+    gemm(op::none, op::transpose, jb, jb, k, alpha, A + j0 * lda, lda, A + j0 * lda, lda, T(0.0), diag_block.data(), jb);
+    for (size_t i = 0; i < jb; ++i) {
+      T* crow = C + (j0 + i) * ldc + j0;
+      for (size_t j = 0; j <= i; ++j) crow[j] = (beta == T(0.0) ? T(0.0) : beta * crow[j]) + diag_block[i * jb + j];
+    }
+    size_t rest = n - j0 - jb;
+    if (rest) gemm(op::none, op::transpose, rest, jb, k, alpha, A + (j0 + jb) * lda, lda, A + j0 * lda, lda, beta, C + (j0 + jb) * ldc + j0, ldc);
+  }
+}
+
+}  // namespace blas
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
@@ -0,0 +1,883 @@
+#pragma once
+
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "blas.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+namespace detail {
+
+constexpr size_t lu_base_width = 16;
+
+/// @brief Recursive right-looking LU (Toledo) of columns [c0, c0 + w) and rows [c0, n) of the row-major
+/// n x n matrix a. The left half is factored recursively, the block row to its right is solved with trsm,
+/// the trailing block is updated with gemm (where almost all flops are spent) and the right half is
+/// factored recursively. Pivot rows are swapped across the full row, so earlier L columns and later
+/// columns see the same permutation. Returns the first zero pivot column, or n if there is none.
+template <typename T>
+size_t lu_recursive(T* a, size_t n, size_t c0, size_t w, size_t* piv, bool pivoting) {
+  size_t first_zero = n;
+  if (w <= lu_base_width) {
+    for (size_t j = c0; j < c0 + w; ++j) {
+      size_t p = j;
+      if (pivoting) {
+        T best = std::abs(a[j * n + j]);
+        for (size_t i = j + 1; i < n; ++i) {
+          T v = std::abs(a[i * n + j]);
+          if (v > best) best = v, p = i;
+        }
+      }
+      if (piv) piv[j] = p;
+      if (p != j) std::swap_ranges(a + j * n, a + (j + 1) * n, a + p * n);
+      T d = a[j * n + j];
+      if (d == T(0.0)) {
+        first_zero = std::min(first_zero, j);
+        continue;
+      }
+      const T* uj = a + j * n;
+      size_t c_end = c0 + w;
+      utility::parallel_for(j + 1, n, 2048, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+          T* ai = a + i * n;
+          T l = ai[j] /= d;
+          if (l == T(0.0)) continue;
+          for (size_t c = j + 1; c < c_end; ++c) ai[c] -= l * uj[c];
+        }
+      });
+    }
+    return first_zero;
+  }
+  size_t w1 = w / 2;
+  if (w1 > lu_base_width) w1 -= w1 % lu_base_width;
+  size_t c1 = c0 + w1;
+  first_zero = lu_recursive(a, n, c0, w1, piv, pivoting);
+  blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::unit, w1, w - w1, T(1.0), a + c0 * n + c0, n, a + c0 * n + c1, n);
+  blas::gemm(blas::op::none, blas::op::none, n - c1, w - w1, w1, T(-1.0), a + c1 * n + c0, n, a + c0 * n + c1, n, T(1.0), a + c1 * n + c1, n);
+  return std::min(first_zero, lu_recursive(a, n, c1, w - w1, piv, pivoting));
+}
+
+constexpr size_t cholesky_block = 128;
+
+/// @brief Blocked right-looking Cholesky (potrf) of the row-major n x n matrix a, overwriting the lower
+/// triangle with L and zeroing the strict upper triangle as each block row is finished. Per block: the
+/// diagonal block is factored directly, the panel below it is solved with trsm_right, and the trailing
+/// lower triangle is updated with syrk_lower. Returns the first column with a non-positive pivot, or n.
+template <typename T>
+size_t potrf_lower(T* a, size_t n) {
+  for (size_t k0 = 0; k0 < n; k0 += cholesky_block) {
+    size_t kb = std::min(cholesky_block, n - k0);
+    for (size_t j = k0; j < k0 + kb; ++j) {
+      T* aj = a + j * n;
+      T d = aj[j];
+      for (size_t c = k0; c < j; ++c) d -= aj[c] * aj[c];
+      if (!(d > T(0.0))) return j;
+      d = std::sqrt(d);
+      aj[j] = d;
+      for (size_t i = j + 1; i < k0 + kb; ++i) {
+        T* ai = a + i * n;
+        T sum = ai[j];
+        for (size_t c = k0; c < j; ++c) sum -= ai[c] * aj[c];
+        ai[j] = sum / d;
+      }
+      std::fill(aj + j + 1, aj + n, T(0.0));
+    }
+    size_t rest = n - k0 - kb;
+    if (rest == 0) break;
+    T* a21 = a + (k0 + kb) * n + k0;
+    blas::trsm_right(blas::uplo::lower, blas::op::transpose, blas::diag::non_unit, rest, kb, T(1.0), a + k0 * n + k0, n, a21, n);
+    blas::syrk_lower(rest, kb, T(-1.0), a21, n, T(1.0), a + (k0 + kb) * n + k0 + kb, n);
+  }
+  return n;
+}
+
+constexpr size_t qr_block = 32;
+
+/// @brief 2-norm of column col over rows [i0, i1), scaled by the largest entry to avoid overflow.
+template <typename T>
+T column_norm(const T* a, size_t lda, size_t i0, size_t i1, size_t col) {
+  T scale = T(0.0);
+  for (size_t i = i0; i < i1; ++i) scale = std::max(scale, std::abs(a[i * lda + col]));
+  if (scale == T(0.0)) return scale;
+  T sum = T(0.0);
+  for (size_t i = i0; i < i1; ++i) {
+    T v = a[i * lda + col] / scale;
+    sum += v * v;
+  }
+  return scale * std::sqrt(sum);
+}
+
+/// @brief Generates the Householder reflector H = I - tau v v^T (v_0 = 1) that maps column col of the
+/// row-major matrix a, rows [j, m), onto beta e_1. beta is stored at (j, col), v below it (LAPACK larfg).
+template <typename T>
+T householder_column(T* a, size_t lda, size_t m, size_t j, size_t col) {
+  T alpha = a[j * lda + col];
+  T xnorm = column_norm(a, lda, j + 1, m, col);
+  if (xnorm == T(0.0)) return T(0.0);
+  T beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+  T scale = T(1.0) / (alpha - beta);
+  for (size_t i = j + 1; i < m; ++i) a[i * lda + col] *= scale;
+  a[j * lda + col] = beta;
+  return (beta - alpha) / beta;
+}
+
+/// @brief Applies H = I - tau v v^T, with v stored in column vcol of a below row j (v_0 = 1), to columns
+/// [c0, c1) of rows [j, m). w = v^T C is accumulated row by row into per-thread partials.
+template <typename T>
+void apply_householder(T* a, size_t lda, size_t m, size_t j, size_t vcol, size_t c0, size_t c1, T tau) {
+  if (tau == T(0.0) || c0 >= c1) return;
+  size_t nc = c1 - c0, rows = m - j;
+  size_t chunks = std::min(utility::num_threads(), std::max<size_t>(1, rows * nc / (size_t(1) << 15)));
+  std::vector<std::vector<T>> partial(chunks, std::vector<T>(nc, T(0.0)));
+  auto v = [&](size_t i) { return i == j ? T(1.0) : a[i * lda + vcol]; };
+  utility::thread_pool::instance().run(chunks, [&](size_t c) {
+    T* w = partial[c].data();
+    for (size_t i = j + rows * c / chunks; i < j + rows * (c + 1) / chunks; ++i) {
+      T vi = v(i);
+      const T* row = a + i * lda + c0;
+      for (size_t k = 0; k < nc; ++k) w[k] += vi * row[k];
+    }
+  });
+  for (size_t c = 1; c < chunks; ++c) {
+    for (size_t k = 0; k < nc; ++k) partial[0][k] += partial[c][k];
+  }
+  const T* w = partial[0].data();
+  utility::parallel_for(j, m, std::max<size_t>(64, (size_t(1) << 14) / nc), [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      T f = tau * v(i);
+      T* row = a + i * lda + c0;
+      for (size_t k = 0; k < nc; ++k) row[k] -= f * w[k];
+    }
+  });
+}
+
+/// @brief Forms the triangular factor T (kb x kb, upper) of the compact WY representation
+/// H_0 ... H_(kb-1) = I - V T V^T, given the explicit reflector block V (L x kb, row-major, unit
+/// diagonal) and the scalars tau[0..kb) (LAPACK larft, forward columnwise).
+template <typename T>
+void form_block_t(const std::vector<T>& V, size_t L, size_t kb, const T* tau, std::vector<T>& Tm) {
+  std::vector<T> G(kb * kb);
+  blas::gemm(blas::op::transpose, blas::op::none, kb, kb, L, T(1.0), V.data(), kb, V.data(), kb, T(0.0), G.data(), kb);
+  Tm.assign(kb * kb, T(0.0));
+  std::vector<T> z(kb);
+  for (size_t i = 0; i < kb; ++i) {
+    Tm[i * kb + i] = tau[i];
+    for (size_t c = 0; c < i; ++c) z[c] = -tau[i] * G[c * kb + i];
+    for (size_t r = 0; r < i; ++r) {
+      T sum = T(0.0);
+      for (size_t c = r; c < i; ++c) sum += Tm[r * kb + c] * z[c];
+      Tm[r * kb + i] = sum;
+    }
+  }
+}
+
+/// @brief Compact WY representation H_j0 ... H_(j0+kb-1) = I - V T V^T of kb consecutive reflectors
+/// stored below the diagonal of a: V explicit (rows [j0, m), row-major, unit diagonal) and T upper
+/// triangular kb x kb.
+template <typename T>
+void block_reflector(const T* a, size_t lda, size_t m, size_t j0, size_t kb, const T* tau, std::vector<T>& V, std::vector<T>& Tm) {
+  size_t L = m - j0;
+  V.assign(L * kb, T(0.0));
+  for (size_t r = 0; r < L; ++r) {
+    for (size_t c = 0; c < kb && c <= r; ++c) V[r * kb + c] = r == c ? T(1.0) : a[(j0 + r) * lda + j0 + c];
+  }
+  form_block_t(V, L, kb, tau + j0, Tm);
+}
+
+/// @brief C := (I - V T V^T) C, or with T^T when transpose is set, for C L x nc with leading dimension ldc.
+/// Both products with V go through gemm.
+template <typename T>
+void apply_block_reflector(bool transpose, size_t L, size_t kb, const T* V, const T* Tm, T* C, size_t nc, size_t ldc) {
+  if (nc == 0) return;
+  std::vector<T> W(kb * nc);
+  blas::gemm(blas::op::transpose, blas::op::none, kb, nc, L, T(1.0), V, kb, C, ldc, T(0.0), W.data(), nc);
+  if (transpose) {
+    for (size_t i = kb; i-- > 0;) {
+      T* wi = W.data() + i * nc;
+      T tii = Tm[i * kb + i];
+      for (size_t k = 0; k < nc; ++k) wi[k] *= tii;
+      for (size_t c = 0; c < i; ++c) {
+        T t = Tm[c * kb + i];
+        const T* wc = W.data() + c * nc;
+        for (size_t k = 0; k < nc; ++k) wi[k] += t * wc[k];
+      }
+    }
+  } else {
+    for (size_t i = 0; i < kb; ++i) {
+      T* wi = W.data() + i * nc;
+      T tii = Tm[i * kb + i];
+      for (size_t k = 0; k < nc; ++k) wi[k] *= tii;
+      for (size_t c = i + 1; c < kb; ++c) {
+        T t = Tm[i * kb + c];
+        const T* wc = W.data() + c * nc;
+        for (size_t k = 0; k < nc; ++k) wi[k] += t * wc[k];
+      }
+    }
+  }
+  blas::gemm(blas::op::none, blas::op::none, L, nc, kb, T(-1.0), V, kb, W.data(), nc, T(1.0), C, ldc);
+}
+
+/// @brief Blocked Householder QR (geqrf) of the row-major m x n matrix a: each panel of qr_block columns
+/// is factored with single reflectors, then applied to the trailing columns as one block reflector.
+template <typename T>
+void geqrf(T* a, size_t m, size_t n, T* tau) {
+  size_t kmax = std::min(m, n);
+  std::vector<T> V, Tm;
+  for (size_t k0 = 0; k0 < kmax; k0 += qr_block) {
+    size_t kb = std::min(qr_block, kmax - k0);
+    for (size_t j = k0; j < k0 + kb; ++j) {
+      tau[j] = householder_column(a, n, m, j, j);
+      apply_householder(a, n, m, j, j, j + 1, k0 + kb, tau[j]);
+    }
+    if (k0 + kb < n) {
+      block_reflector(a, n, m, k0, kb, tau, V, Tm);
+      apply_block_reflector(true, m - k0, kb, V.data(), Tm.data(), a + k0 * n + k0 + kb, n - k0 - kb, n);
+    }
+  }
+}
+
+/// @brief Householder QR with column pivoting (geqp3): the remaining column of largest norm is moved
+/// forward at each step, and the column norms are downdated instead of recomputed, with a recomputation
+/// when cancellation makes the downdate unreliable. perm[j] is the original index of column j.
+template <typename T>
+void geqp3(T* a, size_t m, size_t n, T* tau, size_t* perm) {
+  size_t kmax = std::min(m, n);
+  std::vector<T> norms(n, T(0.0)), orig(n);
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t c = 0; c < n; ++c) norms[c] += a[i * n + c] * a[i * n + c];
+  }
+  for (size_t c = 0; c < n; ++c) {
+    norms[c] = orig[c] = std::sqrt(norms[c]);
+    perm[c] = c;
+  }
+  const T tol3z = std::sqrt(std::numeric_limits<T>::epsilon());
+  for (size_t j = 0; j < kmax; ++j) {
+    size_t p = j;
+    for (size_t c = j + 1; c < n; ++c) {
+      if (norms[c] > norms[p]) p = c;
+    }
+    if (p != j) {
+      for (size_t i = 0; i < m; ++i) std::swap(a[i * n + j], a[i * n + p]);
+      std::swap(norms[j], norms[p]);
+      std::swap(orig[j], orig[p]);
+      std::swap(perm[j], perm[p]);
+    }
+    tau[j] = householder_column(a, n, m, j, j);
+    apply_householder(a, n, m, j, j, j + 1, n, tau[j]);
+    for (size_t c = j + 1; c < n; ++c) {
+      if (norms[c] == T(0.0)) continue;
+      T t = std::abs(a[j * n + c]) / norms[c];
+      t = std::max(T(0.0), (T(1.0) + t) * (T(1.0) - t));
+      T ratio = norms[c] / orig[c];
+      if (t * ratio * ratio <= tol3z) {
+        norms[c] = orig[c] = column_norm(a, n, j + 1, m, c);
+      } else {
+        norms[c] *= std::sqrt(t);
+      }
+    }
+  }
+}
+
+/// @brief 1-norm of the row-major n x n matrix a (maximum absolute column sum). With symmetric_lower only
+/// the lower triangle is read and the matrix is taken as symmetric.
+template <typename T>
+T matrix_norm1(const T* a, size_t n, bool symmetric_lower = false) {
+  std::vector<T> sums(n, T(0.0));
+  for (size_t i = 0; i < n; ++i) {
+    const T* row = a + i * n;
+    if (symmetric_lower) {
+      for (size_t j = 0; j < i; ++j) {
+        sums[j] += std::abs(row[j]);
+        sums[i] += std::abs(row[j]);
+      }
+      sums[i] += std::abs(row[i]);
+    } else {
+      for (size_t j = 0; j < n; ++j) sums[j] += std::abs(row[j]);
+    }
+  }
+  T res = T(0.0);
+  for (T v : sums) res = std::max(res, v);
+  return res;
+}
+
+/// @brief Hager's estimate of ||B||_1 in Higham's refinement (LAPACK lacn2), for a B that is only
+/// available through apply(x, transpose), which overwrites x with Bx or B^T x. At most five pairs of
+/// products plus one extra with an alternating-sign vector that guards against the known
+/// counterexamples; with B = A^-1 this costs a few triangular solves, O(n^2), instead of an inverse.
+/// The estimate is a lower bound, almost always within a factor 3 of the true norm.
+template <typename T, typename Apply>
+T norm1_estimate(size_t n, Apply&& apply) {
+  if (n == 0) return T(0.0);
+  auto norm1 = [&](const std::vector<T>& v) {
+    T sum = T(0.0);
+    for (T vi : v) sum += std::abs(vi);
+    return sum;
+  };
+  auto argmax = [&](const std::vector<T>& v) {
+    size_t j = 0;
+    for (size_t i = 1; i < n; ++i) {
+      if (std::abs(v[i]) > std::abs(v[j])) j = i;
+    }
+    return j;
+  };
+  std::vector<T> x(n, T(1.0) / T(n)), xi(n), z;
+  apply(x.data(), false);
+  T est = norm1(x);
+  if (n == 1) return est;
+  for (size_t i = 0; i < n; ++i) xi[i] = x[i] >= T(0.0) ? T(1.0) : T(-1.0);
+  z = xi;
+  apply(z.data(), true);
+  size_t j = argmax(z);
+  for (int iter = 1; iter < 5; ++iter) {
+    std::fill(x.begin(), x.end(), T(0.0));
+    x[j] = T(1.0);
+    apply(x.data(), false);
+    T prev = est;
+    est = norm1(x);
+    bool same = true;
+    for (size_t i = 0; i < n; ++i) {
+      T si = x[i] >= T(0.0) ? T(1.0) : T(-1.0);
+      same = same && si == xi[i];
+      xi[i] = si;
+    }
+    if (same || est <= prev) {
+      est = std::max(est, prev);
+      break;
+    }
+    z = xi;
+    apply(z.data(), true);
+    size_t jlast = j;
+    j = argmax(z);
+    if (std::abs(z[jlast]) == std::abs(z[j])) break;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    T mag = T(1.0) + T(i) / T(n - 1);
+    x[i] = i % 2 == 0 ? mag : -mag;
+  }
+  apply(x.data(), false);
+  return std::max(est, T(2.0) * norm1(x) / T(3 * n));
+}
+
+/// @brief Reciprocal 1-norm condition number of A from its packed LU factors and row interchanges
+/// (as produced by lu_recursive), given ||A||_1.
+template <typename T>
+T lu_rcond(const T* lu, const size_t* piv, size_t n, T anorm) {
+  if (n == 0) return T(1.0);
+  if (anorm == T(0.0)) return T(0.0);
+  T inv = norm1_estimate<T>(n, [&](T* x, bool transpose) {
+    if (!transpose) {
+      for (size_t i = 0; i < n; ++i) {
+        if (piv[i] != i) std::swap(x[i], x[piv[i]]);
+      }
+      blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::unit, n, 1, T(1.0), lu, n, x, 1);
+      blas::trsm_left(blas::uplo::upper, blas::op::none, blas::diag::non_unit, n, 1, T(1.0), lu, n, x, 1);
+    } else {
+      blas::trsm_left(blas::uplo::upper, blas::op::transpose, blas::diag::non_unit, n, 1, T(1.0), lu, n, x, 1);
+      blas::trsm_left(blas::uplo::lower, blas::op::transpose, blas::diag::unit, n, 1, T(1.0), lu, n, x, 1);
+      for (size_t i = n; i-- > 0;) {
+        if (piv[i] != i) std::swap(x[i], x[piv[i]]);
+      }
+    }
+  });
+  return inv == T(0.0) ? T(0.0) : T(1.0) / (anorm * inv);
+}
+
+}  // namespace detail
+
+/// @brief LU factorization with partial pivoting, PA = LU, of a square dense matrix. The factors are kept
+/// in one n x n tensor (unit lower L below the diagonal, U on and above it) together with the row
+/// interchanges, so the object can be factorized once and reused for many solves, or refactorized for a
+/// new matrix of the same size without reallocating.
+template <typename T = double>
+class lu_factorization {
+ private:
+  tensor<T> _lu;
+  std::vector<size_t> _piv;
+  size_t _n = 0;
+  T _anorm = T(0.0);
+
+  void _factor() {
+    if (_lu.dimensions() != 2 || _lu.shape()[0] != _lu.shape()[1]) {
+      Log::Error("LU factorization failed: matrix must be square.");
+      throw std::invalid_argument("LU factorization requires a square matrix.");
+    }
+    _n = _lu.shape()[0];
+    _piv.resize(_n);
+    if (_n == 0) return;
+    _anorm = detail::matrix_norm1(_lu.raw(), _n);
+    size_t zero = detail::lu_recursive(_lu.raw(), _n, 0, _n, _piv.data(), true);
+    if (zero < _n) {
+      Log::Error("LU factorization failed: matrix is singular (zero pivot in column " + std::to_string(zero) + ").");
+      throw std::runtime_error("Matrix is singular.");
+    }
+  }
+
+  void _check_rhs(size_t rows) const {
+    if (rows != _n) {
+      Log::Error("LU solve failed: right-hand side has " + std::to_string(rows) + " rows, expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Right-hand side size does not match the factorization.");
+    }
+  }
+
+ public:
+  lu_factorization() = default;
+
+  /// @brief Factorizes a.
+  /// @throws std::invalid_argument If a is not a square matrix.
+  /// @throws std::runtime_error If a is singular.
+  explicit lu_factorization(const tensor<T>& a) { factorize(a); }
+
+  /// @brief Factorizes a in place of its own storage.
+  explicit lu_factorization(tensor<T>&& a) { factorize(std::move(a)); }
+
+  /// @brief Factorizes a, reusing the storage of the previous factorization when the size matches.
+  void factorize(const tensor<T>& a) {
+    if (_lu.shape() == a.shape()) std::copy(a.raw(), a.raw() + a.total_size(), _lu.raw());
+    else _lu = a;
+    _factor();
+  }
+
+  /// @brief Factorizes a in place of its own storage (no copy).
+  void factorize(tensor<T>&& a) {
+    _lu = std::move(a);
+    _factor();
+  }
+
+  /// @brief Order of the factorized matrix.
+  size_t size() const { return _n; }
+
+  /// @brief Packed factors: unit lower L strictly below the diagonal, U on and above it.
+  const tensor<T>& lu() const { return _lu; }
+
+  /// @brief Row interchanges: row i was swapped with row pivots()[i], for i = 0, 1, ..., n - 1 in order.
+  const std::vector<size_t>& pivots() const { return _piv; }
+
+  /// @brief Solves Ax = b.
+  /// @throws std::invalid_argument If b has the wrong size.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rhs(b.size());
+    vector<T> x = b;
+    T* px = x.raw();
+    const T* a = _lu.raw();
+    for (size_t i = 0; i < _n; ++i) {
+      if (_piv[i] != i) std::swap(px[i], px[_piv[i]]);
+    }
+    for (size_t i = 1; i < _n; ++i) {
+      const T* row = a + i * _n;
+      T sum = T(0.0);
+      for (size_t j = 0; j < i; ++j) sum += row[j] * px[j];
+      px[i] -= sum;
+    }
+    for (size_t i = _n; i-- > 0;) {
+      const T* row = a + i * _n;
+      T sum = T(0.0);
+      for (size_t j = i + 1; j < _n; ++j) sum += row[j] * px[j];
+      px[i] = (px[i] - sum) / row[i];
+    }
+    return x;
+  }
+
+  /// @brief Solves AX = B for all columns of B (n x k) at once: the row interchanges are applied to whole
+  /// rows of B, followed by two blocked triangular solves.
+  /// @throws std::invalid_argument If B does not have n rows.
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("LU solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    _check_rhs(b.shape()[0]);
+    tensor<T> x = b;
+    size_t k = b.shape()[1];
+    T* px = x.raw();
+    for (size_t i = 0; i < _n; ++i) {
+      if (_piv[i] != i) std::swap_ranges(px + i * k, px + (i + 1) * k, px + _piv[i] * k);
+    }
+    blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::unit, _n, k, T(1.0), _lu.raw(), _n, px, k);
+    blas::trsm_left(blas::uplo::upper, blas::op::none, blas::diag::non_unit, _n, k, T(1.0), _lu.raw(), _n, px, k);
+    return x;
+  }
+
+  /// @brief Estimate of the reciprocal 1-norm condition number 1 / (||A||_1 ||A^-1||_1), from a few
+  /// triangular solves with the stored factors (O(n^2)); ||A||_1 is recorded before factorizing.
+  T rcond() const { return detail::lu_rcond(_lu.raw(), _piv.data(), _n, _anorm); }
+
+  /// @brief Determinant of A: the product of the pivots, with the sign of the row permutation.
+  T det() const {
+    T d = T(1.0);
+    for (size_t i = 0; i < _n; ++i) {
+      d *= _lu.raw()[i * _n + i];
+      if (_piv[i] != i) d = -d;
+    }
+    return d;
+  }
+};
+
+/// @brief Cholesky factorization A = LL^T of a symmetric positive definite matrix, computed blockwise
+/// (see detail::potrf_lower). Only the lower triangle of the input is read.
+template <typename T = double>
+class cholesky_factorization {
+ private:
+  tensor<T> _l;
+  size_t _n = 0;
+  T _anorm = T(0.0);
+
+  void _factor() {
+    if (_l.dimensions() != 2 || _l.shape()[0] != _l.shape()[1]) {
+      Log::Error("Cholesky factorization failed: matrix must be square.");
+      throw std::invalid_argument("Cholesky factorization requires a square matrix.");
+    }
+    _n = _l.shape()[0];
+    _anorm = detail::matrix_norm1(_l.raw(), _n, true);
+    if (detail::potrf_lower(_l.raw(), _n) < _n) {
+      Log::Error("Cholesky decomposition failed: Matrix is not positive definite.");
+      throw std::domain_error("Matrix is not positive definite.");
+    }
+  }
+
+  void _check_rhs(size_t rows) const {
+    if (rows != _n) {
+      Log::Error("Cholesky solve failed: right-hand side has " + std::to_string(rows) + " rows, expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Right-hand side size does not match the factorization.");
+    }
+  }
+
+ public:
+  cholesky_factorization() = default;
+
+  /// @brief Factorizes a.
+  /// @throws std::invalid_argument If a is not a square matrix.
+  /// @throws std::domain_error If a is not positive definite.
+  explicit cholesky_factorization(const tensor<T>& a) { factorize(a); }
+
+  /// @brief Factorizes a in place of its own storage.
+  explicit cholesky_factorization(tensor<T>&& a) { factorize(std::move(a)); }
+
+  /// @brief Factorizes a, reusing the storage of the previous factorization when the size matches.
+  void factorize(const tensor<T>& a) {
+    if (_l.shape() == a.shape()) std::copy(a.raw(), a.raw() + a.total_size(), _l.raw());
+    else _l = a;
+    _factor();
+  }
+
+  /// @brief Factorizes a in place of its own storage (no copy).
+  void factorize(tensor<T>&& a) {
+    _l = std::move(a);
+    _factor();
+  }
+
+  /// @brief Order of the factorized matrix.
+  size_t size() const { return _n; }
+
+  /// @brief The lower triangular factor L (upper triangle is zero).
+  const tensor<T>& l() const { return _l; }
+
+  /// @brief Solves Ax = b.
+  /// @throws std::invalid_argument If b has the wrong size.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rhs(b.size());
+    vector<T> x = b;
+    blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::non_unit, _n, 1, T(1.0), _l.raw(), _n, x.raw(), 1);
+    blas::trsm_left(blas::uplo::lower, blas::op::transpose, blas::diag::non_unit, _n, 1, T(1.0), _l.raw(), _n, x.raw(), 1);
+    return x;
+  }
+
+  /// @brief Solves AX = B for all columns of B (n x k) at once with blocked triangular solves.
+  /// @throws std::invalid_argument If B does not have n rows.
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("Cholesky solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    _check_rhs(b.shape()[0]);
+    tensor<T> x = b;
+    size_t k = b.shape()[1];
+    blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::non_unit, _n, k, T(1.0), _l.raw(), _n, x.raw(), k);
+    blas::trsm_left(blas::uplo::lower, blas::op::transpose, blas::diag::non_unit, _n, k, T(1.0), _l.raw(), _n, x.raw(), k);
+    return x;
+  }
+
+  /// @brief Estimate of the reciprocal 1-norm condition number of A, from a few pairs of triangular
+  /// solves (A^-1 is symmetric, so no transposed solves are needed).
+  T rcond() const {
+    if (_n == 0) return T(1.0);
+    if (_anorm == T(0.0)) return T(0.0);
+    T inv = detail::norm1_estimate<T>(_n, [&](T* x, bool) {
+      blas::trsm_left(blas::uplo::lower, blas::op::none, blas::diag::non_unit, _n, 1, T(1.0), _l.raw(), _n, x, 1);
+      blas::trsm_left(blas::uplo::lower, blas::op::transpose, blas::diag::non_unit, _n, 1, T(1.0), _l.raw(), _n, x, 1);
+    });
+    return T(1.0) / (_anorm * inv);
+  }
+
+  /// @brief Determinant of A, the squared product of the diagonal of L.
+  T det() const {
+    T d = T(1.0);
+    for (size_t i = 0; i < _n; ++i) d *= _l.raw()[i * _n + i];
+    return d * d;
+  }
+};
+
+/// @brief Householder QR factorization A = QR (or AP = QR with column pivoting) of an m x n matrix. R and
+/// the reflectors defining Q are stored compactly in one m x n tensor, like LAPACK geqrf/geqp3. Q is
+/// never formed unless requested: apply_qt / apply_q work with the reflectors directly, in blocked WY
+/// form for matrices. Backward stable, unlike Gram-Schmidt, and the pivoted variant reveals the rank.
+template <typename T = double>
+class qr_factorization {
+ private:
+  tensor<T> _qr;
+  std::vector<T> _tau;
+  std::vector<size_t> _perm;
+  size_t _m = 0, _n = 0;
+  bool _pivoted = false;
+
+  void _factor(bool column_pivoting) {
+    if (_qr.dimensions() != 2) {
+      Log::Error("QR factorization failed: input must be a 2D matrix.");
+      throw std::invalid_argument("QR factorization requires a 2D matrix.");
+    }
+    _m = _qr.shape()[0];
+    _n = _qr.shape()[1];
+    _pivoted = column_pivoting;
+    _tau.assign(std::min(_m, _n), T(0.0));
+    _perm.resize(_n);
+    if (column_pivoting) {
+      detail::geqp3(_qr.raw(), _m, _n, _tau.data(), _perm.data());
+    } else {
+      std::iota(_perm.begin(), _perm.end(), size_t(0));
+      detail::geqrf(_qr.raw(), _m, _n, _tau.data());
+    }
+  }
+
+  size_t _solve_rank() const {
+    T r00 = _tau.empty() ? T(0.0) : std::abs(_qr.raw()[0]);
+    size_t r = rank(static_cast<T>(std::max(_m, _n)) * std::numeric_limits<T>::epsilon() * r00);
+    if (!_pivoted && r < _n) {
+      Log::Error("QR solve failed: matrix is rank deficient; factorize with column pivoting.");
+      throw std::runtime_error("Matrix is rank deficient.");
+    }
+    return r;
+  }
+
+  void _check_rows(size_t rows) const {
+    if (rows != _m) {
+      Log::Error("QR failed: operand has " + std::to_string(rows) + " rows, expected " + std::to_string(_m) + ".");
+      throw std::invalid_argument("Operand size does not match the factorization.");
+    }
+  }
+
+  void _apply(bool transpose, T* b, size_t k) const {
+    size_t kmax = _tau.size();
+    std::vector<T> V, Tm;
+    size_t blocks = (kmax + detail::qr_block - 1) / detail::qr_block;
+    for (size_t s = 0; s < blocks; ++s) {
+      size_t blk = transpose ? s : blocks - 1 - s;
+      size_t j0 = blk * detail::qr_block, kb = std::min(detail::qr_block, kmax - j0);
+      detail::block_reflector(_qr.raw(), _n, _m, j0, kb, _tau.data(), V, Tm);
+      detail::apply_block_reflector(transpose, _m - j0, kb, V.data(), Tm.data(), b + j0 * k, k, k);
+    }
+  }
+
+  void _apply(bool transpose, T* b) const {
+    const T* a = _qr.raw();
+    size_t kmax = _tau.size();
+    for (size_t s = 0; s < kmax; ++s) {
+      size_t j = transpose ? s : kmax - 1 - s;
+      if (_tau[j] == T(0.0)) continue;
+      T w = b[j];
+      for (size_t i = j + 1; i < _m; ++i) w += a[i * _n + j] * b[i];
+      w *= _tau[j];
+      b[j] -= w;
+      for (size_t i = j + 1; i < _m; ++i) b[i] -= w * a[i * _n + j];
+    }
+  }
+
+ public:
+  qr_factorization() = default;
+
+  /// @brief Factorizes a; with column_pivoting the columns are reordered so that |R_ii| decreases.
+  /// @throws std::invalid_argument If a is not a 2D matrix.
+  explicit qr_factorization(const tensor<T>& a, bool column_pivoting = false) { factorize(a, column_pivoting); }
+
+  /// @brief Factorizes a in place of its own storage.
+  explicit qr_factorization(tensor<T>&& a, bool column_pivoting = false) {
+    factorize(std::move(a), column_pivoting);
+  }
+
+  /// @brief Factorizes a, reusing the storage of the previous factorization when the shape matches.
+  void factorize(const tensor<T>& a, bool column_pivoting = false) {
+    if (_qr.shape() == a.shape()) std::copy(a.raw(), a.raw() + a.total_size(), _qr.raw());
+    else _qr = a;
+    _factor(column_pivoting);
+  }
+
+  /// @brief Factorizes a in place of its own storage (no copy).
+  void factorize(tensor<T>&& a, bool column_pivoting = false) {
+    _qr = std::move(a);
+    _factor(column_pivoting);
+  }
+
+  size_t rows() const { return _m; }
+  size_t cols() const { return _n; }
+
+  /// @brief Packed factorization: R on and above the diagonal, reflector vectors below it.
+  const tensor<T>& qr() const { return _qr; }
+
+  /// @brief Reflector scalars, H_j = I - tau_j v_j v_j^T.
+  const std::vector<T>& tau() const { return _tau; }
+
+  /// @brief Column permutation: column j of AP is column permutation()[j] of A (identity without pivoting).
+  const std::vector<size_t>& permutation() const { return _perm; }
+
+  /// @brief The min(m, n) x n upper triangular factor R.
+  tensor<T> r() const {
+    size_t k = _tau.size();
+    tensor<T> res({k, _n});
+    for (size_t i = 0; i < k; ++i) {
+      std::copy(_qr.raw() + i * _n + i, _qr.raw() + (i + 1) * _n, res.raw() + i * _n + i);
+    }
+    return res;
+  }
+
+  /// @brief The thin orthogonal factor Q (m x min(m, n)), formed by applying Q to the identity.
+  tensor<T> q() const {
+    size_t k = _tau.size();
+    tensor<T> res({_m, k});
+    for (size_t i = 0; i < k; ++i) res.raw()[i * k + i] = T(1.0);
+    _apply(false, res.raw(), k);
+    return res;
+  }
+
+  /// @brief Q^T b without forming Q.
+  vector<T> apply_qt(const vector<T>& b) const {
+    _check_rows(b.size());
+    vector<T> x = b;
+    _apply(true, x.raw());
+    return x;
+  }
+
+  /// @brief Q b without forming Q.
+  vector<T> apply_q(const vector<T>& b) const {
+    _check_rows(b.size());
+    vector<T> x = b;
+    _apply(false, x.raw());
+    return x;
+  }
+
+  /// @brief Q^T B for all columns of B (m x k), one block reflector (two gemm calls) per panel.
+  tensor<T> apply_qt(const tensor<T>& b) const {
+    _check_rows(b.shape()[0]);
+    tensor<T> x = b;
+    _apply(true, x.raw(), b.shape()[1]);
+    return x;
+  }
+
+  /// @brief Q B for all columns of B (m x k).
+  tensor<T> apply_q(const tensor<T>& b) const {
+    _check_rows(b.shape()[0]);
+    tensor<T> x = b;
+    _apply(false, x.raw(), b.shape()[1]);
+    return x;
+  }
+
+  /// @brief Number of diagonal entries of R with |R_ii| > tol. Meaningful with column pivoting.
+  size_t rank(T tol) const {
+    size_t r = 0;
+    while (r < _tau.size() && std::abs(_qr.raw()[r * _n + r]) > tol) ++r;
+    return r;
+  }
+
+  /// @brief Least-squares solution of min ||Ax - b||. Uses the leading r x r block of R, where r is the
+  /// numerical rank (|R_ii| > max(m, n) eps |R_00|); with column pivoting a rank-deficient A gets the
+  /// basic solution with n - r zero components.
+  /// @throws std::invalid_argument If b has the wrong size.
+  /// @throws std::runtime_error If A is rank deficient and was factorized without pivoting.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rows(b.size());
+    vector<T> y = apply_qt(b);
+    size_t r = _solve_rank();
+    const T* a = _qr.raw();
+    for (size_t i = r; i-- > 0;) {
+      T sum = y[i];
+      for (size_t j = i + 1; j < r; ++j) sum -= a[i * _n + j] * y[j];
+      y[i] = sum / a[i * _n + i];
+    }
+    vector<T> x(_n);
+    for (size_t j = 0; j < r; ++j) x[_perm[j]] = y[j];
+    return x;
+  }
+
+  /// @brief Least-squares solutions for all columns of B (m x k) at once: Q^T B in blocked WY form and
+  /// one blocked triangular solve with R. Rank handling as in solve(vector).
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("QR solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    tensor<T> y = apply_qt(b);
+    size_t r = _solve_rank(), k = b.shape()[1];
+    blas::trsm_left(blas::uplo::upper, blas::op::none, blas::diag::non_unit, r, k, T(1.0), _qr.raw(), _n, y.raw(), k);
+    tensor<T> x({_n, k});
+    for (size_t j = 0; j < r; ++j) std::copy(y.raw() + j * k, y.raw() + (j + 1) * k, x.raw() + _perm[j] * k);
+    return x;
+  }
+
+  /// @brief Estimate of the reciprocal 1-norm condition number of the triangular factor R of a square A.
+  /// A and R share their 2-norm condition number, and the 1-norm ones agree within a factor n.
+  /// @throws std::invalid_argument If A is not square.
+  T rcond() const {
+    if (_m != _n) {
+      Log::Error("QR rcond failed: matrix must be square.");
+      throw std::invalid_argument("rcond requires a square matrix.");
+    }
+    if (_n == 0) return T(1.0);
+    const T* a = _qr.raw();
+    T rnorm = T(0.0);
+    for (size_t j = 0; j < _n; ++j) {
+      T sum = T(0.0);
+      for (size_t i = 0; i <= j; ++i) sum += std::abs(a[i * _n + j]);
+      rnorm = std::max(rnorm, sum);
+    }
+    for (size_t i = 0; i < _n; ++i) {
+      if (a[i * _n + i] == T(0.0)) return T(0.0);
+    }
+    T inv = detail::norm1_estimate<T>(_n, [&](T* x, bool transpose) {
+      blas::trsm_left(blas::uplo::upper, transpose ? blas::op::transpose : blas::op::none, blas::diag::non_unit, _n, 1,
+                      T(1.0), a, _n, x, 1);
+    });
+    return T(1.0) / (rnorm * inv);
+  }
+
+  /// @brief Determinant of a square A: the product of diag(R), with one sign flip per nontrivial
+  /// reflector and the sign of the column permutation.
+  /// @throws std::invalid_argument If A is not square.
+  T det() const {
+    if (_m != _n) {
+      Log::Error("QR determinant failed: matrix must be square.");
+      throw std::invalid_argument("Determinant requires a square matrix.");
+    }
+    T d = T(1.0);
+    for (size_t i = 0; i < _n; ++i) {
+      d *= _qr.raw()[i * _n + i];
+      if (_tau[i] != T(0.0)) d = -d;
+    }
+    std::vector<bool> seen(_n, false);
+    for (size_t i = 0; i < _n; ++i) {
+      if (seen[i]) continue;
+      size_t len = 0;
+      for (size_t j = i; !seen[j]; j = _perm[j], ++len) seen[j] = true;
+      if (len % 2 == 0) d = -d;
+    }
+    return d;
+  }
+};
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
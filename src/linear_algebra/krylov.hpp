@@ -0,0 +1,463 @@
+#pragma once
+
+#include "../common/sparse.hpp"
+#include "../common/sparse_formats.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "linear_operator.hpp"
+#include "preconditioners.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Outcome of a Krylov solve.
+template <typename T = double>
+struct krylov_result {
+  vector<T> x;               // Approximate solution.
+  int iterations = 0;        // Number of iterations performed (inner iterations for GMRES).
+  bool converged = false;    // True if ||b - A x|| <= tol * ||b|| was reached.
+  std::vector<T> residuals;  // Relative residual norm ||r_k|| / ||b||, starting with the initial residual.
+};
+
+namespace detail {
+
+constexpr size_t krylov_grain = size_t(1) << 15;
+
+template <typename T>
+T dot(const vector<T>& a, const vector<T>& b) {
+  const T* ap = a.raw();
+  const T* bp = b.raw();
+  return utility::parallel_reduce<T>(0, a.size(), krylov_grain, [&](size_t lo, size_t hi) {
+    T s = T(0.0);
+    for (size_t i = lo; i < hi; ++i) s += ap[i] * bp[i];
+    return s;
+  });
+}
+
+template <typename T>
+T norm(const vector<T>& a) {
+  return std::sqrt(dot(a, a));
+}
+
+/// @brief y = alpha * x + beta * y
+template <typename T>
+void axpby(T alpha, const vector<T>& x, T beta, vector<T>& y) {
+  const T* xp = x.raw();
+  T* yp = y.raw();
+  utility::parallel_for(0, y.size(), krylov_grain, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) yp[i] = alpha * xp[i] + beta * yp[i];
+  });
+}
+
+/// @brief r = b - A x
+template <typename T, typename Matrix>
+void residual(const Matrix& A, const vector<T>& x, const vector<T>& b, vector<T>& r) {
+  A.multiply(x, r);
+  axpby(T(1.0), b, T(-1.0), r);
+}
+
+template <typename T, typename Matrix>
+void check_system(const Matrix& A, const vector<T>& b, const char* name) {
+  if (A.rows() != A.cols() || b.size() != A.rows()) {
+    Log::Error(std::string(name) + " failed: system must be square and match the right-hand side.");
+    throw std::invalid_argument("Krylov solvers require a square system with matching right-hand side.");
+  }
+}
+
+}  // namespace detail
+
+/// @brief Preconditioned Conjugate Gradient for symmetric positive definite systems.
+/// Any linear_operator (CSR, CSC, BSR, SELL-C-sigma, dense_operator, function_operator) or a dense tensor can be used. A sparse_matrix is checked
+/// for symmetry first, since CG silently produces garbage on nonsymmetric input.
+/// @param A The SPD system matrix.
+/// @param b Right-hand side.
+/// @param M Symmetric positive definite preconditioner.
+/// @param tol Relative residual tolerance ||r|| / ||b||.
+/// @param max_iter Maximum number of iterations.
+/// @throws std::invalid_argument If the matrix is known to be nonsymmetric.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> pcg(const Matrix& A, const vector<T>& b, const preconditioner<T>& M, T tol = T(1e-8), int max_iter = 10000) {
+  const auto& op = detail::as_operator<T>(A);
+  detail::check_system(op, b, "PCG");
+  if constexpr (requires { A.is_symmetric(); }) {
+    if (!A.is_symmetric()) {
+      Log::Error("PCG requires a symmetric matrix; use bicgstab or gmres for nonsymmetric systems.");
+      throw std::invalid_argument("PCG called on a nonsymmetric matrix.");
+    }
+  }
+  size_t n = b.size();
+  krylov_result<T> res;
+  res.x = vector<T>(n);
+  res.residuals.reserve(static_cast<size_t>(max_iter) + 1);
+  T b_norm = detail::norm(b);
+  if (b_norm == T(0.0)) {
+    res.converged = true;
+    res.residuals.push_back(T(0.0));
+    return res;
+  }
+
+  vector<T> r = b, z(n), p(n), Ap(n);
+  M.apply(r, z);
+  p = z;
+  T rz = detail::dot(r, z);
+  res.residuals.push_back(T(1.0));
+
+  for (int it = 0; it < max_iter; ++it) {
+    op.multiply(p, Ap);
+    T pAp = detail::dot(p, Ap);
+    if (pAp <= T(0.0)) {
+      Log::Warn("PCG breakdown: matrix or preconditioner is not positive definite.");
+      break;
+    }
+    T alpha = rz / pAp;
+    detail::axpby(alpha, p, T(1.0), res.x);
+    detail::axpby(-alpha, Ap, T(1.0), r);
+    res.iterations = it + 1;
+    T rel = detail::norm(r) / b_norm;
+    res.residuals.push_back(rel);
+    if (rel <= tol) {
+      res.converged = true;
+      return res;
+    }
+    M.apply(r, z);
+    T rz_new = detail::dot(r, z);
+    detail::axpby(T(1.0), z, rz_new / rz, p);
+    rz = rz_new;
+  }
+  if (!res.converged) Log::Warn("PCG did not converge.");
+  return res;
+}
+
+/// @brief Conjugate Gradient without preconditioning.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> pcg(const Matrix& A, const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) {
+  return pcg(A, b, identity_preconditioner<T>(), tol, max_iter);
+}
+
+/// @brief Right-preconditioned BiCGSTAB for general (nonsymmetric) square systems.
+/// @param A The system matrix.
+/// @param b Right-hand side.
+/// @param M Preconditioner.
+/// @param tol Relative residual tolerance ||r|| / ||b||.
+/// @param max_iter Maximum number of iterations.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> bicgstab(const Matrix& A, const vector<T>& b, const preconditioner<T>& M, T tol = T(1e-8), int max_iter = 10000) {
+  const auto& op = detail::as_operator<T>(A);
+  detail::check_system(op, b, "BiCGSTAB");
+  size_t n = b.size();
+  krylov_result<T> res;
+  res.x = vector<T>(n);
+  res.residuals.reserve(static_cast<size_t>(max_iter) + 1);
+  T b_norm = detail::norm(b);
+  if (b_norm == T(0.0)) {
+    res.converged = true;
+    res.residuals.push_back(T(0.0));
+    return res;
+  }
+
+  vector<T> r = b, r_hat = b, p(n), v(n), s(n), t(n), p_hat(n), s_hat(n);
+  T rho = T(1.0), alpha = T(1.0), omega = T(1.0);
+  res.residuals.push_back(T(1.0));
+
+  for (int it = 0; it < max_iter; ++it) {
+    T rho_new = detail::dot(r_hat, r);
+    if (rho_new == T(0.0)) {
+      Log::Warn("BiCGSTAB breakdown: rho = 0.");
+      break;
+    }
+    if (it == 0) {
+      p = r;
+    } else {
+      T beta = (rho_new / rho) * (alpha / omega);
+      // p = r + beta * (p - omega * v)
+      detail::axpby(-omega, v, T(1.0), p);
+      detail::axpby(T(1.0), r, beta, p);
+    }
+    M.apply(p, p_hat);
+    op.multiply(p_hat, v);
+    T rv = detail::dot(r_hat, v);
+    if (rv == T(0.0)) {
+      Log::Warn("BiCGSTAB breakdown: (r_hat, v) = 0.");
+      break;
+    }
+    alpha = rho_new / rv;
+    s = r;
+    detail::axpby(-alpha, v, T(1.0), s);
+    res.iterations = it + 1;
+    T s_rel = detail::norm(s) / b_norm;
+    if (s_rel <= tol) {
+      detail::axpby(alpha, p_hat, T(1.0), res.x);
+      res.residuals.push_back(s_rel);
+      res.converged = true;
+      return res;
+    }
+    M.apply(s, s_hat);
+    op.multiply(s_hat, t);
+    T tt = detail::dot(t, t);
+    omega = (tt == T(0.0)) ? T(0.0) : detail::dot(t, s) / tt;
+    detail::axpby(alpha, p_hat, T(1.0), res.x);
+    detail::axpby(omega, s_hat, T(1.0), res.x);
+    r = s;
+    detail::axpby(-omega, t, T(1.0), r);
+    T rel = detail::norm(r) / b_norm;
+    res.residuals.push_back(rel);
+    if (rel <= tol) {
+      res.converged = true;
+      return res;
+    }
+    if (omega == T(0.0)) {
+      Log::Warn("BiCGSTAB breakdown: omega = 0.");
+      break;
+    }
+    rho = rho_new;
+  }
+  if (!res.converged) Log::Warn("BiCGSTAB did not converge.");
+  return res;
+}
+
+/// @brief BiCGSTAB without preconditioning.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> bicgstab(const Matrix& A, const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) {
+  return bicgstab(A, b, identity_preconditioner<T>(), tol, max_iter);
+}
+
+namespace detail {
+
+/// @brief Restarted GMRES(m) loop behind linear_algebra::gmres. With quiet set, breakdown, stagnation and
+/// the iteration limit are reported only through krylov_result::converged, for callers that stop the
+/// solve early on purpose, such as the inexact inner solves of newton_krylov.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> gmres(const Matrix& A, const vector<T>& b, const preconditioner<T>& M, size_t restart, T tol, int max_iter, bool quiet) {
+  const auto& op = detail::as_operator<T>(A);
+  detail::check_system(op, b, "GMRES");
+  size_t n = b.size();
+  size_t m = std::max<size_t>(1, std::min(restart, n));
+  krylov_result<T> res;
+  res.x = vector<T>(n);
+  res.residuals.reserve(static_cast<size_t>(max_iter) + 1);
+  T b_norm = detail::norm(b);
+  if (b_norm == T(0.0)) {
+    res.converged = true;
+    res.residuals.push_back(T(0.0));
+    return res;
+  }
+
+  std::vector<vector<T>> V(m + 1, vector<T>(n));
+  std::vector<T> H((m + 1) * m, T(0.0));  // column-major, H[i + j * (m + 1)]
+  std::vector<T> cs(m), sn(m), g(m + 1), y(m);
+  vector<T> w(n), z(n), r(n);
+  auto h = [&](size_t i, size_t j) -> T& { return H[i + j * (m + 1)]; };
+
+  detail::residual(op, res.x, b, r);
+  T beta = detail::norm(r);
+  res.residuals.push_back(beta / b_norm);
+
+  while (res.iterations < max_iter) {
+    detail::axpby(T(1.0) / beta, r, T(0.0), V[0]);
+    std::fill(g.begin(), g.end(), T(0.0));
+    g[0] = beta;
+
+    size_t k = 0;
+    for (; k < m && res.iterations < max_iter; ++k) {
+      M.apply(V[k], z);
+      op.multiply(z, w);
+      for (size_t i = 0; i <= k; ++i) {
+        h(i, k) = detail::dot(w, V[i]);
+        detail::axpby(-h(i, k), V[i], T(1.0), w);
+      }
+      h(k + 1, k) = detail::norm(w);
+      if (h(k + 1, k) != T(0.0)) detail::axpby(T(1.0) / h(k + 1, k), w, T(0.0), V[k + 1]);
+
+      for (size_t i = 0; i < k; ++i) {
+        T tmp = cs[i] * h(i, k) + sn[i] * h(i + 1, k);
+        h(i + 1, k) = -sn[i] * h(i, k) + cs[i] * h(i + 1, k);
+        h(i, k) = tmp;
+      }
+      T denom = std::hypot(h(k, k), h(k + 1, k));
+      if (denom == T(0.0)) {
+        // A M^-1 v_k lies in span(v_0, ..., v_(k-1)) and is annihilated by the rotations: A is singular on
+        // the Krylov space. With k == 0 there is nothing to update; otherwise use the first k columns.
+        if (!quiet) Log::Warn("GMRES breakdown: singular Hessenberg matrix.");
+        if (k == 0) return res;
+        ++res.iterations;
+        res.residuals.push_back(std::abs(g[k]) / b_norm);
+        break;
+      }
+      cs[k] = h(k, k) / denom;
+      sn[k] = h(k + 1, k) / denom;
+      h(k, k) = denom;
+      h(k + 1, k) = T(0.0);
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+
+      ++res.iterations;
+      T rel = std::abs(g[k + 1]) / b_norm;
+      res.residuals.push_back(rel);
+      if (rel <= tol) {
+        ++k;
+        break;
+      }
+    }
+
+    // Solve the k x k upper triangular system and update x += M^-1 (V y).
+    for (size_t i = k; i-- > 0;) {
+      T sum = g[i];
+      for (size_t j = i + 1; j < k; ++j) sum -= h(i, j) * y[j];
+      y[i] = sum / h(i, i);
+    }
+    std::fill(w.begin(), w.end(), T(0.0));
+    for (size_t j = 0; j < k; ++j) detail::axpby(y[j], V[j], T(1.0), w);
+    M.apply(w, z);
+    detail::axpby(T(1.0), z, T(1.0), res.x);
+
+    T beta_prev = beta;
+    detail::residual(op, res.x, b, r);
+    beta = detail::norm(r);
+    if (beta / b_norm <= tol) {
+      res.residuals.back() = beta / b_norm;
+      res.converged = true;
+      return res;
+    }
+    if (!(beta < beta_prev)) {
+      if (!quiet) Log::Warn("GMRES stagnated: a restart cycle did not reduce the residual.");
+      return res;
+    }
+  }
+  if (!quiet) Log::Warn("GMRES did not converge.");
+  return res;
+}
+
+
+}  // namespace detail
+
+/// @brief Right-preconditioned restarted GMRES(m) with modified Gram-Schmidt Arnoldi and Givens rotations.
+/// The Krylov basis, Hessenberg matrix and rotations are allocated once before the first cycle.
+/// @param A The system matrix.
+/// @param b Right-hand side.
+/// @param M Preconditioner.
+/// @param restart Krylov subspace dimension m between restarts.
+/// @param tol Relative residual tolerance ||r|| / ||b||.
+/// @param max_iter Maximum total number of inner iterations.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> gmres(const Matrix& A,
+                       const vector<T>& b,
+                       const preconditioner<T>& M,
+                       size_t restart = 30,
+                       T tol = T(1e-8),
+                       int max_iter = 10000) {
+  return detail::gmres(A, b, M, restart, tol, max_iter, false);
+}
+
+/// @brief Restarted GMRES(m) without preconditioning.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> gmres(const Matrix& A, const vector<T>& b, size_t restart = 30, T tol = T(1e-8), int max_iter = 10000) {
+  return gmres(A, b, identity_preconditioner<T>(), restart, tol, max_iter);
+}
+
+/// @brief Preconditioned MINRES (Paige-Saunders) for symmetric, possibly indefinite, systems: minimizes
+/// the residual over the Krylov space with a three-term Lanczos recurrence, so it needs only a fixed set of
+/// seven work vectors, unlike GMRES. The convergence test uses the residual norm maintained by the
+/// recurrence, ||r||_(M^-1) / ||b||_(M^-1), which equals ||r|| / ||b|| without preconditioning.
+/// @param A The symmetric system matrix.
+/// @param b Right-hand side.
+/// @param M Symmetric positive definite preconditioner.
+/// @param tol Relative residual tolerance.
+/// @param max_iter Maximum number of iterations.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> minres(const Matrix& A, const vector<T>& b, const preconditioner<T>& M, T tol = T(1e-8), int max_iter = 10000) {
+  const auto& op = detail::as_operator<T>(A);
+  detail::check_system(op, b, "MINRES");
+  size_t n = b.size();
+  krylov_result<T> res;
+  res.x = vector<T>(n);
+  res.residuals.reserve(static_cast<size_t>(max_iter) + 1);
+
+  vector<T> r1 = b, r2 = b, y(n), v(n), w(n), w1(n), w2(n);
+  M.apply(r1, y);
+  T beta1 = detail::dot(r1, y);
+  if (beta1 < T(0.0)) {
+    Log::Error("MINRES failed: preconditioner is not positive definite.");
+    throw std::invalid_argument("MINRES requires a positive definite preconditioner.");
+  }
+  beta1 = std::sqrt(beta1);
+  if (beta1 == T(0.0)) {
+    res.converged = true;
+    res.residuals.push_back(T(0.0));
+    return res;
+  }
+  res.residuals.push_back(T(1.0));
+
+  T old_beta = T(0.0), beta = beta1, dbar = T(0.0), eps = T(0.0), phibar = beta1;
+  T cs = T(-1.0), sn = T(0.0);
+  for (int it = 0; it < max_iter; ++it) {
+    // Lanczos step: v = y / beta, y = A v - (beta / old_beta) r1 - (alpha / beta) r2.
+    detail::axpby(T(1.0) / beta, y, T(0.0), v);
+    op.multiply(v, y);
+    if (it > 0) detail::axpby(-beta / old_beta, r1, T(1.0), y);
+    T alpha = detail::dot(v, y);
+    detail::axpby(-alpha / beta, r2, T(1.0), y);
+    std::swap(r1, r2);
+    std::swap(r2, y);
+    M.apply(r2, y);
+    old_beta = beta;
+    beta = detail::dot(r2, y);
+    if (beta < T(0.0)) {
+      Log::Warn("MINRES breakdown: preconditioner is not positive definite.");
+      break;
+    }
+    beta = std::sqrt(beta);
+
+    // Apply the previous rotation, then build the new one that annihilates beta.
+    T old_eps = eps;
+    T delta = cs * dbar + sn * alpha;
+    T gbar = sn * dbar - cs * alpha;
+    eps = sn * beta;
+    dbar = -cs * beta;
+    T gamma = std::max(std::hypot(gbar, beta), std::numeric_limits<T>::min());
+    cs = gbar / gamma;
+    sn = beta / gamma;
+    T phi = cs * phibar;
+    phibar *= sn;
+
+    // w = (v - old_eps w1 - delta w2) / gamma, x += phi w.
+    std::swap(w1, w2);
+    std::swap(w2, w);
+    const T* vp = v.raw();
+    const T* w1p = w1.raw();
+    const T* w2p = w2.raw();
+    T* wp = w.raw();
+    T* xp = res.x.raw();
+    utility::parallel_for(0, n, detail::krylov_grain, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        wp[i] = (vp[i] - old_eps * w1p[i] - delta * w2p[i]) / gamma;
+        xp[i] += phi * wp[i];
+      }
+    });
+
+    res.iterations = it + 1;
+    T rel = phibar / beta1;
+    res.residuals.push_back(rel);
+    if (rel <= tol || beta == T(0.0)) {
+      res.converged = true;
+      return res;
+    }
+  }
+  if (!res.converged) Log::Warn("MINRES did not converge.");
+  return res;
+}
+
+/// @brief MINRES without preconditioning.
+template <typename T, operator_source<T> Matrix>
+krylov_result<T> minres(const Matrix& A, const vector<T>& b, T tol = T(1e-8), int max_iter = 10000) {
+  return minres(A, b, identity_preconditioner<T>(), tol, max_iter);
+}
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <concepts>
+
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief A linear map y = A x that only needs to be applied: the dimensions and a product into a
+/// caller-provided buffer (y already has rows() entries and must not alias x). Every sparse format
+/// satisfies it, as do dense_operator and function_operator, so the iterative solvers never allocate
+/// per product.
+template <typename Op, typename T>
+concept linear_operator = requires(const Op& A, const vector<T>& x, vector<T>& y) {
+  { A.rows() } -> std::convertible_to<size_t>;
+  { A.cols() } -> std::convertible_to<size_t>;
+  A.multiply(x, y);
+};
+
+/// @brief A linear_operator that can also apply its transpose, y = A^T x.
+template <typename Op, typename T>
+concept transposable_operator = linear_operator<Op, T> && requires(const Op& A, const vector<T>& x, vector<T>& y) {
+  A.transpose_multiply(x, y);
+};
+
+/// @brief A linear_operator that exposes its main diagonal (for Jacobi-type preconditioning).
+template <typename Op, typename T>
+concept diagonal_operator = linear_operator<Op, T> && requires(const Op& A) {
+  { A.diagonal() } -> std::convertible_to<vector<T>>;
+};
+
+/// @brief Non-owning linear_operator view of a dense row-major matrix. The tensor must outlive the view.
+template <typename T = double>
+class dense_operator {
+ private:
+  const tensor<T>* _a;
+  size_t _rows, _cols;
+
+  static constexpr size_t _grain = size_t(1) << 14;
+
+ public:
+  /// @throws std::invalid_argument If a is not a 2D matrix.
+  explicit dense_operator(const tensor<T>& a) : _a(&a) {
+    if (a.dimensions() != 2) {
+      Log::Error("dense_operator requires a 2D matrix.");
+      throw std::invalid_argument("dense_operator requires a 2D matrix.");
+    }
+    _rows = a.shape()[0];
+    _cols = a.shape()[1];
+  }
+
+  size_t rows() const { return _rows; }
+  size_t cols() const { return _cols; }
+
+  /// @brief y = A x, rows split over the thread pool.
+  void multiply(const vector<T>& x, vector<T>& y) const {
+    const T* a = _a->raw();
+    const T* xp = x.raw();
+    T* yp = y.raw();
+    utility::parallel_for(0, _rows, std::max<size_t>(1, _grain / std::max<size_t>(_cols, 1)), [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) {
+        const T* row = a + i * _cols;
+        T s = T(0.0);
+        for (size_t j = 0; j < _cols; ++j) s += row[j] * xp[j];
+        yp[i] = s;
+      }
+    });
+  }
+
+  /// @brief y = A^T x, accumulated row by row so that the matrix is still read contiguously.
+  void transpose_multiply(const vector<T>& x, vector<T>& y) const {
+    const T* a = _a->raw();
+    T* yp = y.raw();
+    std::fill(yp, yp + _cols, T(0.0));
+    for (size_t i = 0; i < _rows; ++i) {
+      const T* row = a + i * _cols;
+      T xi = x[i];
+      for (size_t j = 0; j < _cols; ++j) yp[j] += row[j] * xi;
+    }
+  }
+
+  vector<T> diagonal() const {
+    size_t n = std::min(_rows, _cols);
+    vector<T> d(n);
+    for (size_t i = 0; i < n; ++i) d[i] = _a->raw()[i * _cols + i];
+    return d;
+  }
+};
+
+/// @brief linear_operator around callables: f(x, y) computes y = A x in place; a callable returning the
+/// product (vector<T> f(const vector<T>&)) is accepted too, at the cost of one allocation per product.
+/// transpose_multiply() is available when a transpose callable Ft is supplied.
+template <typename T, typename F, typename Ft = std::nullptr_t>
+class function_operator {
+ private:
+  size_t _rows, _cols;
+  F _f;
+  Ft _ft;
+
+  template <typename G>
+  static void _call(const G& g, const vector<T>& x, vector<T>& y) {
+    if constexpr (std::is_invocable_r_v<vector<T>, const G&, const vector<T>&>) y = g(x);
+    else g(x, y);
+  }
+
+ public:
+  function_operator(size_t rows, size_t cols, F f, Ft ft = Ft()) : _rows(rows), _cols(cols), _f(std::move(f)), _ft(std::move(ft)) {}
+
+  size_t rows() const { return _rows; }
+  size_t cols() const { return _cols; }
+
+  void multiply(const vector<T>& x, vector<T>& y) const { _call(_f, x, y); }
+
+  void transpose_multiply(const vector<T>& x, vector<T>& y) const
+    requires(!std::is_same_v<Ft, std::nullptr_t>)
+  {
+    _call(_ft, x, y);
+  }
+};
+
+/// @brief Wraps a callable computing y = A x for a square n x n operator.
+template <typename T = double, typename F>
+function_operator<T, F> make_operator(size_t n, F f) {
+  return function_operator<T, F>(n, n, std::move(f));
+}
+
+/// @brief Wraps callables computing y = A x and y = A^T x for an m x n operator.
+template <typename T = double, typename F, typename Ft>
+function_operator<T, F, Ft> make_operator(size_t m, size_t n, F f, Ft ft) {
+  return function_operator<T, F, Ft>(m, n, std::move(f), std::move(ft));
+}
+
+/// @brief What the iterative solvers accept: any linear_operator, or a dense tensor (viewed through
+/// dense_operator).
+template <typename Op, typename T>
+concept operator_source = linear_operator<Op, T> || std::same_as<Op, tensor<T>>;
+
+namespace detail {
+
+/// @brief The linear_operator behind A: A itself, or a dense_operator view of a tensor.
+template <typename T, typename Op>
+decltype(auto) as_operator(const Op& A) {
+  if constexpr (std::same_as<Op, tensor<T>>) return dense_operator<T>(A);
+  else return (A);
+}
+
+}  // namespace detail
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
@@ -4,6 +4,9 @@
 #include "../common/vector.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
+#include "blas.hpp"
+#include "factorizations.hpp"
+#include "svd.hpp"
 
 namespace numc {
 namespace linear_algebra {
@@ -132,197 +135,75 @@ T inf_norm(const tensor<T>& a) {
   return maxVal;
 }
 
-/// @brief Computes the condition number of a matrix using the 1-norm estimation.
+/// @brief Estimates the 1-norm condition number ||A||_1 ||A^-1||_1 from an LU factorization with partial
+/// pivoting and the Hager/Higham estimator: O(n^3 / 3) for the factorization plus a few O(n^2)
+/// triangular solves, without forming the inverse. Returns infinity for a singular matrix.
 template <typename T = double>
 T cond(tensor<T> a) {
-  T normA = inf_norm(a);
   size_t n = a.shape()[0];
-  // Compute inverse via Gauss-Jordan
-  tensor<T> augmented({n, 2 * n});
-  for (size_t i = 0; i < n; ++i) {
-    for (size_t j = 0; j < n; ++j) augmented(i, j) = a(i, j);
-    augmented(i, n + i) = T(1.0);
-  }
-  for (size_t k = 0; k < n; ++k) {
-    // Partial pivot
-    size_t iMax = k;
-    for (size_t i = k + 1; i < n; ++i)
-      if (std::abs(augmented(i, k)) > std::abs(augmented(iMax, k))) iMax = i;
-    if (iMax != k)
-      for (size_t j = 0; j < 2 * n; ++j) {
-        T tmp = augmented(k, j);
-        augmented(k, j) = augmented(iMax, j);
-        augmented(iMax, j) = tmp;
-      }
-    T pivot = augmented(k, k);
-    if (std::abs(pivot) < T(1e-15)) return std::numeric_limits<T>::infinity();
-    for (size_t j = 0; j < 2 * n; ++j) augmented(k, j) /= pivot;
-    for (size_t i = 0; i < n; ++i) {
-      if (i == k) continue;
-      T factor = augmented(i, k);
-      for (size_t j = 0; j < 2 * n; ++j) augmented(i, j) -= factor * augmented(k, j);
-    }
-  }
-  tensor<T> inv({n, n});
-  for (size_t i = 0; i < n; ++i)
-    for (size_t j = 0; j < n; ++j)
-      inv(i, j) = augmented(i, n + j);
-  T normInv = inf_norm(inv);
-  return normA * normInv;
+  if (n == 0) return T(1.0);
+  T anorm = detail::matrix_norm1(a.raw(), n);
+  std::vector<size_t> piv(n);
+  if (detail::lu_recursive(a.raw(), n, 0, n, piv.data(), true) < n) return std::numeric_limits<T>::infinity();
+  T rc = detail::lu_rcond(a.raw(), piv.data(), n, anorm);
+  return rc == T(0.0) ? std::numeric_limits<T>::infinity() : T(1.0) / rc;
 }
 
-/// @brief Computes the rank of a matrix via row echelon form.
+/// @brief Computes the rank of a matrix as the number of |R_ii| > tol in a column-pivoted QR.
 template <typename T = double>
 size_t rank(tensor<T> a, T tol = T(1e-10)) {
-  size_t m = a.shape()[0], n = a.shape()[1];
-  size_t r = 0;
-  for (size_t col = 0; col < n && r < m; ++col) {
-    // Find pivot
-    size_t pivot = m;
-    for (size_t row = r; row < m; ++row) {
-      if (std::abs(a(row, col)) > tol) { pivot = row; break; }
-    }
-    if (pivot == m) continue;
-    // Swap
-    if (pivot != r)
-      for (size_t j = 0; j < n; ++j) {
-        T tmp = a(r, j);
-        a(r, j) = a(pivot, j);
-        a(pivot, j) = tmp;
-      }
-    // Eliminate
-    for (size_t i = r + 1; i < m; ++i) {
-      T factor = a(i, col) / a(r, col);
-      for (size_t j = col; j < n; ++j) a(i, j) -= factor * a(r, j);
-    }
-    ++r;
-  }
-  return r;
+  return qr_factorization<T>(std::move(a), true).rank(tol);
 }
 
-/// @brief QR decomposition using Gram-Schmidt orthogonalization (A = Q * R).
+/// @brief QR decomposition using Householder reflections (A = Q * R), Q thin with orthonormal columns.
+/// Signs are normalized so that R has a non-negative diagonal. See qr_factorization to apply Q without
+/// forming it.
 template <typename T = double>
 std::pair<tensor<T>, tensor<T>> qr_decomp(const tensor<T>& A) {
-  size_t m = A.shape()[0], n = A.shape()[1];
-  tensor<T> Q({m, n});
-  tensor<T> R({n, n});
-
-  for (size_t j = 0; j < n; ++j) {
-    // Copy column j of A
-    vector<T> v(m);
-    for (size_t i = 0; i < m; ++i) v[i] = A(i, j);
-
-    for (size_t k = 0; k < j; ++k) {
-      T dot = T(0.0);
-      for (size_t i = 0; i < m; ++i) dot += Q(i, k) * v[i];
-      R(k, j) = dot;
-      for (size_t i = 0; i < m; ++i) v[i] -= dot * Q(i, k);
-    }
-
-    T norm_v = T(0.0);
-    for (size_t i = 0; i < m; ++i) norm_v += v[i] * v[i];
-    norm_v = std::sqrt(norm_v);
-    R(j, j) = norm_v;
-
-    if (norm_v > T(1e-15)) {
-      for (size_t i = 0; i < m; ++i) Q(i, j) = v[i] / norm_v;
-    }
+  qr_factorization<T> f(A);
+  tensor<T> Q = f.q(), R = f.r();
+  size_t m = Q.shape()[0], k = Q.shape()[1], n = R.shape()[1];
+  for (size_t j = 0; j < k; ++j) {
+    if (R.raw()[j * n + j] >= T(0.0)) continue;
+    for (size_t c = j; c < n; ++c) R.raw()[j * n + c] = -R.raw()[j * n + c];
+    for (size_t i = 0; i < m; ++i) Q.raw()[i * k + j] = -Q.raw()[i * k + j];
   }
   return {Q, R};
 }
 
-/// @brief Singular Value Decomposition using one-sided Jacobi (A = U * S * V^T).
-/// Returns {U, singular_values, V}.
-template <typename T = double>
-std::tuple<tensor<T>, vector<T>, tensor<T>> svd(const tensor<T>& A, T tol = T(1e-10), int max_iter = 100) {
-  size_t m = A.shape()[0], n = A.shape()[1];
-  // Work on A^T * A for the right singular vectors
-  tensor<T> ATA = matmul(transpose(A), A);
-  size_t p = n;
-
-  // Initialize V as identity
-  tensor<T> V = tensor<T>::eye(p);
-
-  // Jacobi iterations on ATA
-  for (int iter = 0; iter < max_iter; ++iter) {
-    T off_diag = T(0.0);
-    for (size_t i = 0; i < p; ++i)
-      for (size_t j = i + 1; j < p; ++j)
-        off_diag += ATA(i, j) * ATA(i, j);
-    if (std::sqrt(off_diag) < tol) break;
-
-    for (size_t i = 0; i < p - 1; ++i) {
-      for (size_t j = i + 1; j < p; ++j) {
-        if (std::abs(ATA(i, j)) < tol) continue;
-        T theta = T(0.5) * std::atan2(T(2.0) * ATA(i, j), ATA(i, i) - ATA(j, j));
-        T c = std::cos(theta), s = std::sin(theta);
-
-        // Apply Givens rotation to ATA
-        for (size_t k = 0; k < p; ++k) {
-          T aik = ATA(k, i), ajk = ATA(k, j);
-          ATA(k, i) = c * aik + s * ajk;
-          ATA(k, j) = -s * aik + c * ajk;
-        }
-        for (size_t k = 0; k < p; ++k) {
-          T aki = ATA(i, k), akj = ATA(j, k);
-          ATA(i, k) = c * aki + s * akj;
-          ATA(j, k) = -s * aki + c * akj;
-        }
-
-        // Accumulate V
-        for (size_t k = 0; k < p; ++k) {
-          T vki = V(k, i), vkj = V(k, j);
-          V(k, i) = c * vki + s * vkj;
-          V(k, j) = -s * vki + c * vkj;
-        }
-      }
-    }
-  }
-
-  // Singular values are sqrt of eigenvalues of ATA
-  vector<T> sigma(p);
-  for (size_t i = 0; i < p; ++i) {
-    sigma[i] = std::sqrt(std::max(ATA(i, i), T(0.0)));
-  }
-
-  // U = A * V * Sigma^(-1)
-  tensor<T> U({m, p});
-  tensor<T> AV = matmul(A, V);
-  for (size_t j = 0; j < p; ++j) {
-    if (sigma[j] > tol) {
-      for (size_t i = 0; i < m; ++i) {
-        U(i, j) = AV(i, j) / sigma[j];
-      }
-    }
-  }
-
-  return {U, sigma, V};
-}
-
 /// @brief Computes the pseudo-inverse (Moore-Penrose) of a matrix using SVD.
+/// Singular values not above tol are treated as zero.
 template <typename T = double>
 tensor<T> pinv(const tensor<T>& A, T tol = T(1e-10)) {
-  auto [U, sigma, V] = svd(A, tol);
+  auto [U, sigma, V] = svd(A);
   size_t m = U.shape()[0], n = V.shape()[0], k = sigma.size();
 
-  // Sigma_plus = diag(1/sigma_i) for non-zero sigma_i
-  tensor<T> result({n, m});
-  for (size_t i = 0; i < k; ++i) {
-    if (sigma[i] > tol) {
-      T inv_s = T(1.0) / sigma[i];
-      for (size_t row = 0; row < n; ++row)
-        for (size_t col = 0; col < m; ++col)
-          result(row, col) += V(row, i) * inv_s * U(col, i);
-    }
+  // A^+ = V * Sigma^+ * U^T, with Sigma^+ folded into the columns of V.
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < k; ++j) V.raw()[i * k + j] *= sigma[j] > tol ? T(1.0) / sigma[j] : T(0.0);
   }
+  tensor<T> result({n, m});
+  blas::gemm(blas::op::none, blas::op::transpose, n, m, k, T(1.0), V.raw(), k, U.raw(), k, T(0.0), result.raw(), m);
   return result;
 }
 
-/// @brief Solves the least-squares problem min ||Ax - b||^2 using SVD.
+/// @brief Solves the least-squares problem min ||Ax - b||^2. A of full column rank goes through a
+/// column-pivoted Householder QR; rank-deficient problems get the minimum-norm solution from the SVD.
 template <typename T = double>
 vector<T> lstsq(const tensor<T>& A, const vector<T>& b, T tol = T(1e-10)) {
-  tensor<T> Ap = pinv(A, tol);
-  return matvec(Ap, b);
+  size_t m = A.shape()[0], n = A.shape()[1];
+  if (m >= n) {
+    qr_factorization<T> f(A, true);
+    if (f.rank(tol) == n) return f.solve(b);
+  }
+  auto [U, sigma, V] = svd(A);
+  size_t k = sigma.size();
+  vector<T> c(k);
+  blas::gemm(blas::op::transpose, blas::op::none, k, 1, m, T(1.0), U.raw(), k, b.raw(), 1, T(0.0), c.raw(), 1);
+  for (size_t j = 0; j < k; ++j) c[j] = sigma[j] > tol ? c[j] / sigma[j] : T(0.0);
+  vector<T> x(n);
+  blas::gemm(blas::op::none, blas::op::none, n, 1, k, T(1.0), V.raw(), k, c.raw(), 1, T(0.0), x.raw(), 1);
+  return x;
 }
 
 /// @}
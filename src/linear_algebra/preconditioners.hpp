@@ -0,0 +1,275 @@
+#pragma once
+
+#include "../common/sparse.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Interface of a preconditioner M ~ A used by the Krylov solvers.
+/// apply() computes z = M^-1 r and must not allocate, since it runs once or twice per iteration.
+template <typename T = double>
+class preconditioner {
+ public:
+  virtual ~preconditioner() = default;
+
+  /// @brief Computes z = M^-1 r. z has the same size as r and must not alias it.
+  virtual void apply(const vector<T>& r, vector<T>& z) const = 0;
+};
+
+/// @brief The trivial preconditioner M = I.
+template <typename T = double>
+class identity_preconditioner : public preconditioner<T> {
+ public:
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    const T* rp = r.raw();
+    T* zp = z.raw();
+    utility::parallel_for(0, r.size(), size_t(1) << 15, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) zp[i] = rp[i];
+    });
+  }
+};
+
+/// @brief Finds the position of the diagonal entry of every row of a square CSR matrix.
+/// @throws std::invalid_argument If the matrix is not square.
+/// @throws std::domain_error If a diagonal entry is missing or zero.
+template <typename T = double>
+std::vector<size_t> diagonal_positions(const sparse_matrix<T>& A) {
+  if (A.rows() != A.cols()) {
+    Log::Error("Preconditioner construction failed: matrix is not square.");
+    throw std::invalid_argument("Preconditioners require a square matrix.");
+  }
+  const auto& rp = A.row_ptr();
+  const auto& ci = A.col_indices();
+  const auto& v = A.values();
+  std::vector<size_t> diag(A.rows());
+  for (size_t i = 0; i < A.rows(); ++i) {
+    auto first = ci.begin() + rp[i];
+    auto last = ci.begin() + rp[i + 1];
+    auto it = std::lower_bound(first, last, i);
+    if (it == last || *it != i || v[it - ci.begin()] == T(0.0)) {
+      Log::Error("Preconditioner construction failed: zero or missing diagonal in row " + std::to_string(i) + ".");
+      throw std::domain_error("Matrix has a zero diagonal entry.");
+    }
+    diag[i] = static_cast<size_t>(it - ci.begin());
+  }
+  return diag;
+}
+
+/// @brief Jacobi (diagonal) preconditioner: M = diag(A).
+template <typename T = double>
+class jacobi_preconditioner : public preconditioner<T> {
+ private:
+  vector<T> _inv_diag;
+
+ public:
+  explicit jacobi_preconditioner(const sparse_matrix<T>& A) : _inv_diag(A.rows()) {
+    std::vector<size_t> diag = diagonal_positions(A);
+    for (size_t i = 0; i < A.rows(); ++i) _inv_diag[i] = T(1.0) / A.values()[diag[i]];
+  }
+
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    const T* rp = r.raw();
+    const T* dp = _inv_diag.raw();
+    T* zp = z.raw();
+    utility::parallel_for(0, r.size(), size_t(1) << 15, [&](size_t lo, size_t hi) {
+      for (size_t i = lo; i < hi; ++i) zp[i] = dp[i] * rp[i];
+    });
+  }
+};
+
+/// @brief Symmetric successive over-relaxation preconditioner:
+/// M = (D + wL) D^-1 (D + wU) / (w (2 - w)), with 0 < w < 2. Symmetric whenever A is.
+template <typename T = double>
+class ssor_preconditioner : public preconditioner<T> {
+ private:
+  const sparse_matrix<T>& _A;
+  std::vector<size_t> _diag;
+  T _omega;
+
+ public:
+  /// @param A The system matrix. It is referenced, not copied, and must outlive the preconditioner.
+  /// @param omega Relaxation factor in (0, 2); omega = 1 gives symmetric Gauss-Seidel.
+  explicit ssor_preconditioner(const sparse_matrix<T>& A, T omega = T(1.0)) : _A(A), _diag(diagonal_positions(A)), _omega(omega) {
+    if (omega <= T(0.0) || omega >= T(2.0)) {
+      Log::Error("SSOR preconditioner: omega must lie in (0, 2).");
+      throw std::invalid_argument("SSOR relaxation factor out of range.");
+    }
+  }
+
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    const size_t* rp = _A.row_ptr().data();
+    const size_t* ci = _A.col_indices().data();
+    const T* v = _A.values().data();
+    const T* rr = r.raw();
+    T* zp = z.raw();
+    size_t n = _A.rows();
+    T scale = _omega * (T(2.0) - _omega);
+
+    // (D + wL) y = w (2 - w) r
+    for (size_t i = 0; i < n; ++i) {
+      T sum = T(0.0);
+      for (size_t k = rp[i]; k < _diag[i]; ++k) sum += v[k] * zp[ci[k]];
+      zp[i] = (scale * rr[i] - _omega * sum) / v[_diag[i]];
+    }
+    // (D + wU) z = D y
+    for (size_t i = n; i-- > 0;) {
+      T sum = T(0.0);
+      for (size_t k = _diag[i] + 1; k < rp[i + 1]; ++k) sum += v[k] * zp[ci[k]];
+      zp[i] = zp[i] - _omega * sum / v[_diag[i]];
+    }
+  }
+};
+
+/// @brief Incomplete LU factorization with zero fill-in, ILU(0): L and U keep the sparsity pattern of A.
+template <typename T = double>
+class ilu0_preconditioner : public preconditioner<T> {
+ private:
+  std::vector<size_t> _row_ptr;
+  std::vector<size_t> _col_indices;
+  std::vector<T> _lu;
+  std::vector<size_t> _diag;
+
+ public:
+  explicit ilu0_preconditioner(const sparse_matrix<T>& A)
+      : _row_ptr(A.row_ptr()), _col_indices(A.col_indices()), _lu(A.values()), _diag(diagonal_positions(A)) {
+    size_t n = A.rows();
+    std::vector<size_t> pos(n, SIZE_MAX);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) pos[_col_indices[k]] = k;
+      // IKJ variant: eliminate with every pivot row k < i present in row i.
+      for (size_t kk = _row_ptr[i]; kk < _diag[i]; ++kk) {
+        size_t k = _col_indices[kk];
+        T piv = _lu[_diag[k]];
+        if (piv == T(0.0)) {
+          Log::Error("ILU(0) breakdown: zero pivot in row " + std::to_string(k) + ".");
+          throw std::domain_error("ILU(0) encountered a zero pivot.");
+        }
+        T lik = _lu[kk] / piv;
+        _lu[kk] = lik;
+        for (size_t jj = _diag[k] + 1; jj < _row_ptr[k + 1]; ++jj) {
+          size_t p = pos[_col_indices[jj]];
+          if (p != SIZE_MAX) _lu[p] -= lik * _lu[jj];
+        }
+      }
+      for (size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k) pos[_col_indices[k]] = SIZE_MAX;
+    }
+  }
+
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    size_t n = _diag.size();
+    const T* rr = r.raw();
+    T* zp = z.raw();
+    // L y = r (unit lower triangular)
+    for (size_t i = 0; i < n; ++i) {
+      T sum = rr[i];
+      for (size_t k = _row_ptr[i]; k < _diag[i]; ++k) sum -= _lu[k] * zp[_col_indices[k]];
+      zp[i] = sum;
+    }
+    // U z = y
+    for (size_t i = n; i-- > 0;) {
+      T sum = zp[i];
+      for (size_t k = _diag[i] + 1; k < _row_ptr[i + 1]; ++k) sum -= _lu[k] * zp[_col_indices[k]];
+      zp[i] = sum / _lu[_diag[i]];
+    }
+  }
+};
+
+/// @brief Incomplete Cholesky factorization with zero fill-in, IC(0): A ~ L L^T with L on the lower pattern of A.
+/// If a non-positive pivot appears, the factorization is retried on A + alpha * diag(A) with a growing shift.
+template <typename T = double>
+class ic0_preconditioner : public preconditioner<T> {
+ private:
+  std::vector<size_t> _row_ptr;
+  std::vector<size_t> _col_indices;
+  std::vector<T> _l;
+
+  /// @brief Attempts the factorization with the given diagonal shift; returns false on breakdown.
+  bool _factorize(const std::vector<T>& a, T shift) {
+    size_t n = _row_ptr.size() - 1;
+    _l = a;
+    for (size_t i = 0; i < n; ++i) {
+      size_t end = _row_ptr[i + 1];
+      for (size_t kk = _row_ptr[i]; kk < end; ++kk) {
+        size_t k = _col_indices[kk];
+        // Sparse dot product of rows i and k of L over columns j < k.
+        T sum = T(0.0);
+        size_t p = _row_ptr[i], q = _row_ptr[k];
+        size_t q_end = _row_ptr[k + 1] - 1;  // exclude the diagonal of row k
+        while (p < kk && q < q_end) {
+          size_t cp = _col_indices[p], cq = _col_indices[q];
+          if (cp == cq) sum += _l[p++] * _l[q++];
+          else if (cp < cq) ++p;
+          else ++q;
+        }
+        if (k < i) {
+          _l[kk] = (_l[kk] - sum) / _l[_row_ptr[k + 1] - 1];
+        } else {
+          T d = _l[kk] * (T(1.0) + shift) - sum;
+          if (d <= T(0.0)) return false;
+          _l[kk] = std::sqrt(d);
+        }
+      }
+    }
+    return true;
+  }
+
+ public:
+  explicit ic0_preconditioner(const sparse_matrix<T>& A) {
+    diagonal_positions(A);
+    size_t n = A.rows();
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    const auto& v = A.values();
+    std::vector<T> lower;
+    _row_ptr.assign(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = rp[i]; k < rp[i + 1] && ci[k] <= i; ++k) {
+        _col_indices.push_back(ci[k]);
+        lower.push_back(v[k]);
+      }
+      _row_ptr[i + 1] = _col_indices.size();
+    }
+
+    T shift = T(0.0);
+    for (int attempt = 0; !_factorize(lower, shift); ++attempt) {
+      if (attempt == 20) {
+        Log::Error("IC(0) failed: matrix is too far from positive definite.");
+        throw std::domain_error("IC(0) factorization broke down.");
+      }
+      shift = (shift == T(0.0)) ? T(1e-3) : shift * T(2.0);
+      Log::Warn("IC(0) breakdown, retrying with diagonal shift " + std::to_string(shift) + ".");
+    }
+  }
+
+  void apply(const vector<T>& r, vector<T>& z) const override {
+    size_t n = _row_ptr.size() - 1;
+    const T* rr = r.raw();
+    T* zp = z.raw();
+    // L y = r
+    for (size_t i = 0; i < n; ++i) {
+      T sum = rr[i];
+      size_t d = _row_ptr[i + 1] - 1;
+      for (size_t k = _row_ptr[i]; k < d; ++k) sum -= _l[k] * zp[_col_indices[k]];
+      zp[i] = sum / _l[d];
+    }
+    // L^T z = y, column-oriented over the rows of L
+    for (size_t i = n; i-- > 0;) {
+      size_t d = _row_ptr[i + 1] - 1;
+      zp[i] /= _l[d];
+      T zi = zp[i];
+      for (size_t k = _row_ptr[i]; k < d; ++k) zp[_col_indices[k]] -= _l[k] * zi;
+    }
+  }
+};
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
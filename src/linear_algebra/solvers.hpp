@@ -4,6 +4,8 @@
 #include "../common/vector.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
+#include "blas.hpp"
+#include "factorizations.hpp"
 
 namespace numc {
 namespace linear_algebra {
@@ -38,21 +40,12 @@ vector<T> gauss_elimin(tensor<T> a, vector<T> b) {
   return b;
 }
 
-/// @brief Performs LU decomposition (Doolittle method) in-place on matrix A.
+/// @brief Performs LU decomposition (Doolittle method, no pivoting) in-place on matrix A.
+/// Uses the recursive blocked kernel of lu_factorization; prefer lu_factorization, which pivots.
 template <typename T = double>
 tensor<T> lu_decomp(tensor<T> a) {
   size_t n = a.shape()[0];
-  for (size_t k = 0; k < n - 1; ++k) {
-    for (size_t i = k + 1; i < n; ++i) {
-      if (a(i, k) != T(0.0)) {
-        T lam = a(i, k) / a(k, k);
-        for (size_t j = k + 1; j < n; ++j) {
-          a(i, j) -= lam * a(k, j);
-        }
-        a(i, k) = lam;
-      }
-    }
-  }
+  if (n > 0) detail::lu_recursive(a.raw(), n, 0, n, static_cast<size_t*>(nullptr), false);
   return a;
 }
 
@@ -60,56 +53,33 @@ tensor<T> lu_decomp(tensor<T> a) {
 template <typename T = double>
 vector<T> lu_solve(const tensor<T>& lu, vector<T> b) {
   size_t n = lu.shape()[0];
+  const T* a = lu.raw();
   for (size_t k = 1; k < n; ++k) {
     T sum = T(0.0);
     for (size_t j = 0; j < k; ++j) {
-      sum += lu(k, j) * b[j];
+      sum += a[k * n + j] * b[j];
     }
     b[k] -= sum;
   }
   for (int k = static_cast<int>(n) - 1; k >= 0; --k) {
     T sum = T(0.0);
     for (size_t j = k + 1; j < n; ++j) {
-      sum += lu(k, j) * b[j];
+      sum += a[k * n + j] * b[j];
     }
-    b[k] = (b[k] - sum) / lu(k, k);
+    b[k] = (b[k] - sum) / a[k * n + k];
   }
   return b;
 }
 
 /// @brief Performs Cholesky decomposition A = LL^T. Returns the lower triangular matrix L.
+/// Blocked and parallel; see cholesky_factorization for a reusable object with solves.
 template <typename T = double>
 tensor<T> choleski(tensor<T> a) {
-  size_t n = a.shape()[0];
-  for (size_t k = 0; k < n; ++k) {
-    T sum_diag = T(0.0);
-    for (size_t j = 0; j < k; ++j) {
-      sum_diag += a(k, j) * a(k, j);
-    }
-    T val = a(k, k) - sum_diag;
-    if (val <= T(0.0)) {
-      Log::Error("Cholesky decomposition failed: Matrix is not positive definite.");
-      throw std::domain_error("Matrix is not positive definite.");
-    }
-    a(k, k) = std::sqrt(val);
-    for (size_t i = k + 1; i < n; ++i) {
-      T sum_row = T(0.0);
-      for (size_t j = 0; j < k; ++j) {
-        sum_row += a(i, j) * a(k, j);
-      }
-      a(i, k) = (a(i, k) - sum_row) / a(k, k);
-    }
-  }
-  // Zero out the upper triangle
-  for (size_t k = 1; k < n; ++k) {
-    for (size_t i = 0; i < k; ++i) {
-      a(i, k) = T(0.0);
-    }
-  }
-  return a;
+  return cholesky_factorization<T>(std::move(a)).l();
 }
 
 /// @brief Performs LU decomposition of a tridiagonal matrix defined by diagonals c, d, e.
+/// No pivoting; banded_lu_factorization handles any bandwidth with partial pivoting.
 template <typename T = double>
 std::tuple<vector<T>, vector<T>, vector<T>> lu_decomp3(vector<T> c, vector<T> d, vector<T> e) {
   size_t n = d.size();
@@ -136,6 +106,7 @@ vector<T> lu_solve3(const vector<T>& c, const vector<T>& d, const vector<T>& e,
 }
 
 /// @brief Performs LU decomposition of a symmetric pentadiagonal matrix defined by diagonals d, e, f.
+/// No pivoting; see banded_lu_factorization and banded_cholesky_factorization for general bands.
 template <typename T = double>
 std::tuple<vector<T>, vector<T>, vector<T>> lu_decomp5(vector<T> d, vector<T> e, vector<T> f) {
   size_t n = d.size();
@@ -329,22 +300,19 @@ vector<T> lu_solve_pivot(const tensor<T>& lu, const vector<T>& b, const std::vec
 }
 
 /// @brief Computes the inverse of a matrix using LU decomposition with pivoting.
+/// All n columns are solved at once with blocked triangular solves.
 template <typename T = double>
 tensor<T> mat_inv(tensor<T> a) {
   size_t n = a.shape()[0];
-  tensor<T> aInv = tensor<T>::eye(n);
-  auto [lu, seq] = lu_decomp_pivot(a);
-  for (size_t i = 0; i < n; ++i) {
-    vector<T> col(n);
-    for (size_t j = 0; j < n; ++j) {
-      col[j] = aInv(j, i);
-    }
-    vector<T> sol = lu_solve_pivot(lu, col, seq);
-    for (size_t j = 0; j < n; ++j) {
-      aInv(j, i) = sol[j];
-    }
+  lu_factorization<T> f(std::move(a));
+  T rc = f.rcond();
+  if (rc < std::numeric_limits<T>::epsilon()) {
+    // std::to_string uses %f, which would print every rcond that triggers this warning as 0.000000.
+    std::ostringstream oss;
+    oss << std::scientific << rc;
+    Log::Warn("mat_inv: matrix is ill-conditioned (rcond = " + oss.str() + "); the inverse is inaccurate.");
   }
-  return aInv;
+  return f.solve(tensor<T>::eye(n));
 }
 
 /// @brief Solves a sparse linear system using Gauss-Seidel method with relaxation.
@@ -389,6 +357,10 @@ std::tuple<vector<T>, int, T> gauss_seidel(
 }
 
 /// @brief Solves a linear system Ax = b using the Conjugate Gradient method.
+/// One product with A per iteration; the residual is updated by the recurrence r -= alpha A s rather than
+/// recomputed. Av returns a new vector per product; pcg with make_operator avoids that allocation.
+/// @param tol Absolute tolerance on ||r||.
+/// @return The solution and the number of iterations (at most n).
 template <typename T = double>
 std::pair<vector<T>, int> conj_grad(
     std::function<vector<T>(const vector<T>&)> Av,
@@ -396,32 +368,29 @@ std::pair<vector<T>, int> conj_grad(
     const vector<T>& b,
     T tol = T(1e-9)) {
   size_t n = b.size();
-  vector<T> Ax = Av(x);
-  vector<T> r = b - Ax;
+  vector<T> r = b - Av(x);
   vector<T> s = r;
+  T rr = r * r;
   int it = 0;
 
-  for (size_t i = 0; i < n; ++i) {
+  for (size_t i = 0; i < n && std::sqrt(rr) >= tol; ++i) {
     vector<T> u = Av(s);
-    T s_dot_r = s * r;
     T s_dot_u = s * u;
-    if (std::abs(s_dot_u) < T(1e-12)) break;
-    T alpha = s_dot_r / s_dot_u;
-    x = x + alpha * s;
-
-    vector<T> Av_x = Av(x);
-    r = b - Av_x;
-
-    T r_norm = r.norm();
-    if (r_norm < tol) {
-      it = i + 1;
-      break;
+    if (s_dot_u == T(0.0)) break;
+    T alpha = rr / s_dot_u;
+    T* xp = x.raw();
+    T* rp = r.raw();
+    T* sp = s.raw();
+    const T* up = u.raw();
+    for (size_t k = 0; k < n; ++k) {
+      xp[k] += alpha * sp[k];
+      rp[k] -= alpha * up[k];
     }
-
-    T r_dot_u = r * u;
-    T beta = -r_dot_u / s_dot_u;
-    s = r + beta * s;
-    it = i + 1;
+    T rr_new = r * r;
+    T beta = rr_new / rr;
+    rr = rr_new;
+    for (size_t k = 0; k < n; ++k) sp[k] = rp[k] + beta * sp[k];
+    it = static_cast<int>(i) + 1;
   }
   return {x, it};
 }
@@ -0,0 +1,727 @@
+#pragma once
+
+#include <queue>
+
+#include "../common/sparse.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Fill-reducing orderings available to the sparse direct solvers.
+enum class sparse_ordering {
+  natural,  ///< Keep the original numbering.
+  rcm,      ///< Reverse Cuthill-McKee: bandwidth/profile reduction.
+  amd       ///< Approximate minimum degree: fill reduction.
+};
+
+namespace detail {
+
+constexpr size_t npos = static_cast<size_t>(-1);
+
+/// @brief Adjacency structure of A + A^T without the diagonal, in CSR form with sorted neighbours.
+template <typename T>
+std::pair<std::vector<size_t>, std::vector<size_t>> symmetric_pattern(const sparse_matrix<T>& A) {
+  size_t n = A.rows();
+  const auto& rp = A.row_ptr();
+  const auto& ci = A.col_indices();
+  std::vector<size_t> count(n + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+      size_t j = ci[k];
+      if (j == i) continue;
+      ++count[i + 1];
+      ++count[j + 1];
+    }
+  }
+  for (size_t i = 0; i < n; ++i) count[i + 1] += count[i];
+  std::vector<size_t> adj(count[n]);
+  std::vector<size_t> next(count.begin(), count.end() - 1);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+      size_t j = ci[k];
+      if (j == i) continue;
+      adj[next[i]++] = j;
+      adj[next[j]++] = i;
+    }
+  }
+  // Sort and remove duplicates (entries present in both triangles appear twice).
+  std::vector<size_t> ptr(n + 1, 0);
+  size_t out = 0;
+  for (size_t i = 0; i < n; ++i) {
+    auto first = adj.begin() + count[i];
+    auto last = adj.begin() + count[i + 1];
+    std::sort(first, last);
+    size_t start = out;
+    for (auto it = first; it != last; ++it) {
+      if (out == start || adj[out - 1] != *it) adj[out++] = *it;
+    }
+    ptr[i + 1] = out;
+  }
+  adj.resize(out);
+  return {ptr, adj};
+}
+
+/// @brief Breadth-first level structure from `root`; returns the last level and its depth.
+inline std::pair<std::vector<size_t>, size_t> bfs_levels(const std::vector<size_t>& ptr,
+                                                         const std::vector<size_t>& adj,
+                                                         size_t root,
+                                                         std::vector<size_t>& level) {
+  std::vector<size_t> current = {root}, last;
+  std::fill(level.begin(), level.end(), npos);
+  level[root] = 0;
+  size_t depth = 0;
+  while (!current.empty()) {
+    last = current;
+    std::vector<size_t> next;
+    for (size_t v : current) {
+      for (size_t k = ptr[v]; k < ptr[v + 1]; ++k) {
+        if (level[adj[k]] == npos) {
+          level[adj[k]] = depth + 1;
+          next.push_back(adj[k]);
+        }
+      }
+    }
+    if (!next.empty()) ++depth;
+    current.swap(next);
+  }
+  return {last, depth};
+}
+
+/// @brief Quotient-graph minimum degree ordering with AMD's approximate external degree bound
+/// and element absorption (no supervariable detection).
+inline std::vector<size_t> amd(size_t n, const std::vector<size_t>& ptr, const std::vector<size_t>& idx) {
+  enum : unsigned char { VARIABLE, ELEMENT, ABSORBED };
+  std::vector<std::vector<size_t>> vars(n), elems(n), members(n);
+  std::vector<unsigned char> status(n, VARIABLE);
+  std::vector<size_t> degree(n), mark(n, 0), wmark(n, 0);
+  std::vector<long> w(n, 0);
+  using entry = std::pair<size_t, size_t>;
+  std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+  for (size_t i = 0; i < n; ++i) {
+    vars[i].assign(idx.begin() + ptr[i], idx.begin() + ptr[i + 1]);
+    degree[i] = vars[i].size();
+    heap.push({degree[i], i});
+  }
+
+  std::vector<size_t> perm;
+  perm.reserve(n);
+  std::vector<size_t> Lp;
+  size_t stamp = 0;
+  for (size_t k = 0; k < n; ++k) {
+    size_t p;
+    while (true) {
+      auto [d, v] = heap.top();
+      heap.pop();
+      if (status[v] == VARIABLE && d == degree[v]) {
+        p = v;
+        break;
+      }
+    }
+    perm.push_back(p);
+    status[p] = ELEMENT;
+
+    // Lp = (A_p U union of L_e for e adjacent to p) \ {p}; absorbed elements are released.
+    ++stamp;
+    mark[p] = stamp;
+    Lp.clear();
+    for (size_t v : vars[p]) {
+      if (status[v] == VARIABLE && mark[v] != stamp) {
+        mark[v] = stamp;
+        Lp.push_back(v);
+      }
+    }
+    for (size_t e : elems[p]) {
+      if (status[e] != ELEMENT) continue;
+      for (size_t v : members[e]) {
+        if (status[v] == VARIABLE && mark[v] != stamp) {
+          mark[v] = stamp;
+          Lp.push_back(v);
+        }
+      }
+      status[e] = ABSORBED;
+      std::vector<size_t>().swap(members[e]);
+    }
+    std::vector<size_t>().swap(vars[p]);
+    std::vector<size_t>().swap(elems[p]);
+    members[p] = Lp;
+
+    // w(e) = |L_e \ L_p| for every element adjacent to a variable of L_p.
+    for (size_t i : Lp) {
+      for (size_t e : elems[i]) {
+        if (status[e] != ELEMENT) continue;
+        if (wmark[e] != stamp) {
+          wmark[e] = stamp;
+          w[e] = static_cast<long>(members[e].size());
+        }
+        --w[e];
+      }
+    }
+
+    size_t remaining = n - k - 1;
+    size_t lp_ext = Lp.empty() ? 0 : Lp.size() - 1;
+    for (size_t i : Lp) {
+      auto& ei = elems[i];
+      size_t out = 0;
+      size_t d = lp_ext;
+      for (size_t e : ei) {
+        if (status[e] != ELEMENT) continue;
+        if (w[e] <= 0) {
+          status[e] = ABSORBED;  // aggressive absorption: L_e is a subset of L_p
+          std::vector<size_t>().swap(members[e]);
+          continue;
+        }
+        ei[out++] = e;
+        d += static_cast<size_t>(w[e]);
+      }
+      ei.resize(out);
+      ei.push_back(p);
+
+      auto& vi = vars[i];
+      out = 0;
+      for (size_t v : vi) {
+        if (status[v] != VARIABLE || mark[v] == stamp) continue;
+        vi[out++] = v;
+      }
+      vi.resize(out);
+      d += out;
+
+      d = std::min({d, degree[i] + lp_ext, remaining});
+      degree[i] = d;
+      heap.push({d, i});
+    }
+  }
+  return perm;
+}
+
+/// @brief Structure of a square CSR matrix with the map back to CSR positions, stored column-wise.
+template <typename T>
+struct csc_pattern {
+  std::vector<size_t> col_ptr, row_idx, csr_pos;
+
+  explicit csc_pattern(const sparse_matrix<T>& A) : col_ptr(A.cols() + 1, 0), row_idx(A.nnz()), csr_pos(A.nnz()) {
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    for (size_t k = 0; k < A.nnz(); ++k) ++col_ptr[ci[k] + 1];
+    for (size_t j = 0; j < A.cols(); ++j) col_ptr[j + 1] += col_ptr[j];
+    std::vector<size_t> next(col_ptr.begin(), col_ptr.end() - 1);
+    for (size_t i = 0; i < A.rows(); ++i) {
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+        size_t p = next[ci[k]]++;
+        row_idx[p] = i;
+        csr_pos[p] = k;
+      }
+    }
+  }
+};
+
+template <typename T>
+void check_square(const sparse_matrix<T>& A, const char* name) {
+  if (A.rows() != A.cols()) {
+    Log::Error(std::string(name) + " failed: matrix is not square.");
+    throw std::invalid_argument("Sparse direct solvers require a square matrix.");
+  }
+}
+
+}  // namespace detail
+
+/// @brief Reverse Cuthill-McKee ordering of the graph of A + A^T, started from a pseudo-peripheral node
+/// in every connected component. Returns perm with perm[new] = old.
+template <typename T = double>
+std::vector<size_t> rcm_ordering(const sparse_matrix<T>& A) {
+  detail::check_square(A, "RCM ordering");
+  size_t n = A.rows();
+  auto [ptr, adj] = detail::symmetric_pattern(A);
+  auto deg = [&](size_t v) { return ptr[v + 1] - ptr[v]; };
+
+  std::vector<size_t> perm;
+  perm.reserve(n);
+  std::vector<bool> visited(n, false);
+  std::vector<size_t> level(n), order(n);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return deg(a) < deg(b); });
+
+  for (size_t start : order) {
+    if (visited[start]) continue;
+    // George-Liu pseudo-peripheral node search.
+    size_t root = start;
+    auto [last, depth] = detail::bfs_levels(ptr, adj, root, level);
+    while (true) {
+      size_t cand = *std::min_element(last.begin(), last.end(), [&](size_t a, size_t b) { return deg(a) < deg(b); });
+      auto [cand_last, cand_depth] = detail::bfs_levels(ptr, adj, cand, level);
+      if (cand_depth <= depth) break;
+      root = cand;
+      last = cand_last;
+      depth = cand_depth;
+    }
+
+    size_t head = perm.size();
+    perm.push_back(root);
+    visited[root] = true;
+    std::vector<size_t> nbrs;
+    while (head < perm.size()) {
+      size_t v = perm[head++];
+      nbrs.clear();
+      for (size_t k = ptr[v]; k < ptr[v + 1]; ++k) {
+        if (!visited[adj[k]]) {
+          visited[adj[k]] = true;
+          nbrs.push_back(adj[k]);
+        }
+      }
+      std::stable_sort(nbrs.begin(), nbrs.end(), [&](size_t a, size_t b) { return deg(a) < deg(b); });
+      perm.insert(perm.end(), nbrs.begin(), nbrs.end());
+    }
+  }
+  std::reverse(perm.begin(), perm.end());
+  return perm;
+}
+
+/// @brief Approximate minimum degree ordering of the graph of A + A^T. Returns perm with perm[new] = old.
+template <typename T = double>
+std::vector<size_t> amd_ordering(const sparse_matrix<T>& A) {
+  detail::check_square(A, "AMD ordering");
+  auto [ptr, adj] = detail::symmetric_pattern(A);
+  return detail::amd(A.rows(), ptr, adj);
+}
+
+/// @brief Computes the requested fill-reducing ordering.
+template <typename T = double>
+std::vector<size_t> fill_reducing_ordering(const sparse_matrix<T>& A, sparse_ordering ordering) {
+  switch (ordering) {
+    case sparse_ordering::rcm: return rcm_ordering(A);
+    case sparse_ordering::amd: return amd_ordering(A);
+    default: {
+      std::vector<size_t> perm(A.rows());
+      std::iota(perm.begin(), perm.end(), size_t(0));
+      return perm;
+    }
+  }
+}
+
+/// @brief Sparse Cholesky factorization P A P^T = L L^T for symmetric positive definite matrices.
+/// analyze() computes the ordering, elimination tree and the full pattern of L once; factorize()
+/// then only does numerical work (left-looking, column by column) and can be called again for any
+/// matrix with the same sparsity pattern. A must store both triangles.
+template <typename T = double>
+class sparse_cholesky {
+ private:
+  size_t _n = 0;
+  std::vector<size_t> _perm, _pinv;
+  std::vector<size_t> _a_row_ptr, _a_col_indices;  // pattern the analysis was done for
+  std::vector<size_t> _a_src, _a_dst;              // A.values()[_a_src[t]] is added to _Lx[_a_dst[t]]
+  std::vector<size_t> _Lp, _Li;                    // CSC pattern of L, diagonal first in every column
+  std::vector<size_t> _Rp, _Rj;                    // row pattern of L (strictly lower part)
+  std::vector<T> _Lx;
+  bool _factorized = false;
+
+  void _check_pattern(const sparse_matrix<T>& A) const {
+    if (_n == 0 && A.rows() != 0) throw std::logic_error("sparse_cholesky::factorize called before analyze.");
+    if (A.rows() != _n || A.row_ptr() != _a_row_ptr || A.col_indices() != _a_col_indices) {
+      Log::Error("Sparse Cholesky: matrix pattern differs from the analyzed one. Call analyze() again.");
+      throw std::invalid_argument("Sparsity pattern does not match the symbolic factorization.");
+    }
+  }
+
+ public:
+  sparse_cholesky() = default;
+
+  /// @brief Analyzes and factorizes A.
+  explicit sparse_cholesky(const sparse_matrix<T>& A, sparse_ordering ordering = sparse_ordering::amd) {
+    analyze(A, ordering);
+    factorize(A);
+  }
+
+  /// @brief Symbolic factorization: ordering, elimination tree and pattern of L.
+  void analyze(const sparse_matrix<T>& A, sparse_ordering ordering = sparse_ordering::amd) {
+    detail::check_square(A, "Sparse Cholesky");
+    _n = A.rows();
+    _a_row_ptr = A.row_ptr();
+    _a_col_indices = A.col_indices();
+    _perm = fill_reducing_ordering(A, ordering);
+    _pinv.assign(_n, 0);
+    for (size_t k = 0; k < _n; ++k) _pinv[_perm[k]] = k;
+    _factorized = false;
+
+    // Lower triangle of C = P A P^T, row by row, remembering where each entry came from.
+    const auto& rp = A.row_ptr();
+    const auto& ci = A.col_indices();
+    std::vector<size_t> cp(_n + 1, 0);
+    for (size_t i = 0; i < _n; ++i) {
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+        size_t r = _pinv[i], c = _pinv[ci[k]];
+        if (c <= r) ++cp[r + 1];
+      }
+    }
+    for (size_t i = 0; i < _n; ++i) cp[i + 1] += cp[i];
+    std::vector<size_t> cj(cp[_n]), csrc(cp[_n]), next(cp.begin(), cp.end() - 1);
+    for (size_t i = 0; i < _n; ++i) {
+      for (size_t k = rp[i]; k < rp[i + 1]; ++k) {
+        size_t r = _pinv[i], c = _pinv[ci[k]];
+        if (c > r) continue;
+        cj[next[r]] = c;
+        csrc[next[r]++] = k;
+      }
+    }
+
+    // Elimination tree (Liu's algorithm with path compression).
+    std::vector<size_t> parent(_n, detail::npos), ancestor(_n, detail::npos);
+    for (size_t k = 0; k < _n; ++k) {
+      for (size_t p = cp[k]; p < cp[k + 1]; ++p) {
+        for (size_t i = cj[p]; i != detail::npos && i < k;) {
+          size_t inext = ancestor[i];
+          ancestor[i] = k;
+          if (inext == detail::npos) parent[i] = k;
+          i = inext;
+        }
+      }
+    }
+
+    // Row patterns of L: row k reaches every ancestor of its entries up to k.
+    std::vector<size_t> mark(_n, detail::npos);
+    _Rp.assign(_n + 1, 0);
+    _Rj.clear();
+    std::vector<size_t> colcount(_n, 1);
+    for (size_t k = 0; k < _n; ++k) {
+      mark[k] = k;
+      for (size_t p = cp[k]; p < cp[k + 1]; ++p) {
+        for (size_t i = cj[p]; i != detail::npos && mark[i] != k; i = parent[i]) {
+          mark[i] = k;
+          _Rj.push_back(i);
+          ++colcount[i];
+        }
+      }
+      _Rp[k + 1] = _Rj.size();
+    }
+
+    // Column pattern of L; rows are appended in increasing order.
+    _Lp.assign(_n + 1, 0);
+    for (size_t j = 0; j < _n; ++j) _Lp[j + 1] = _Lp[j] + colcount[j];
+    _Li.assign(_Lp[_n], 0);
+    std::vector<size_t> fill(_Lp.begin(), _Lp.end() - 1);
+    for (size_t k = 0; k < _n; ++k) {
+      _Li[fill[k]++] = k;
+      for (size_t p = _Rp[k]; p < _Rp[k + 1]; ++p) _Li[fill[_Rj[p]]++] = k;
+    }
+
+    // Destination of every lower entry of C inside L.
+    _a_src.assign(csrc.begin(), csrc.end());
+    _a_dst.resize(cj.size());
+    for (size_t r = 0; r < _n; ++r) {
+      for (size_t p = cp[r]; p < cp[r + 1]; ++p) {
+        size_t c = cj[p];
+        auto it = std::lower_bound(_Li.begin() + _Lp[c], _Li.begin() + _Lp[c + 1], r);
+        _a_dst[p] = static_cast<size_t>(it - _Li.begin());
+      }
+    }
+    _Lx.assign(_Lp[_n], T(0.0));
+  }
+
+  /// @brief Numerical factorization reusing the symbolic analysis.
+  /// @throws std::invalid_argument If the pattern of A differs from the analyzed one.
+  /// @throws std::domain_error If A is not positive definite.
+  void factorize(const sparse_matrix<T>& A) {
+    _check_pattern(A);
+    _factorized = false;
+    std::fill(_Lx.begin(), _Lx.end(), T(0.0));
+    const auto& av = A.values();
+    for (size_t t = 0; t < _a_src.size(); ++t) _Lx[_a_dst[t]] += av[_a_src[t]];
+
+    std::vector<size_t> first(_n), pos(_n);
+    for (size_t k = 0; k < _n; ++k) first[k] = _Lp[k] + 1;
+    for (size_t j = 0; j < _n; ++j) {
+      for (size_t q = _Lp[j]; q < _Lp[j + 1]; ++q) pos[_Li[q]] = q;
+      // Left-looking update with every column k < j that has L(j, k) != 0.
+      for (size_t r = _Rp[j]; r < _Rp[j + 1]; ++r) {
+        size_t k = _Rj[r];
+        size_t p0 = first[k]++;
+        T ljk = _Lx[p0];
+        for (size_t p = p0; p < _Lp[k + 1]; ++p) _Lx[pos[_Li[p]]] -= _Lx[p] * ljk;
+      }
+      T d = _Lx[_Lp[j]];
+      if (!(d > T(0.0))) {
+        Log::Error("Sparse Cholesky failed: matrix is not positive definite.");
+        throw std::domain_error("Matrix is not positive definite.");
+      }
+      d = std::sqrt(d);
+      _Lx[_Lp[j]] = d;
+      for (size_t q = _Lp[j] + 1; q < _Lp[j + 1]; ++q) _Lx[q] /= d;
+    }
+    _factorized = true;
+  }
+
+  /// @brief Solves A x = b with the computed factor.
+  vector<T> solve(const vector<T>& b) const {
+    vector<T> x(_n), work(_n);
+    solve(b, x, work);
+    return x;
+  }
+
+  /// @brief Solves A x = b into a preallocated x, using work (size n, distinct from b) as scratch, so
+  /// repeated solves (e.g. the coarsest level of a multigrid cycle) do not allocate. x may alias b.
+  void solve(const vector<T>& b, vector<T>& x, vector<T>& work) const {
+    if (!_factorized) throw std::logic_error("sparse_cholesky::solve called before factorize.");
+    if (b.size() != _n || x.size() != _n || work.size() != _n) {
+      throw std::invalid_argument("Right-hand side size does not match the factorized matrix.");
+    }
+    T* y = work.raw();
+    for (size_t k = 0; k < _n; ++k) y[k] = b[_perm[k]];
+    for (size_t j = 0; j < _n; ++j) {
+      y[j] /= _Lx[_Lp[j]];
+      T yj = y[j];
+      for (size_t p = _Lp[j] + 1; p < _Lp[j + 1]; ++p) y[_Li[p]] -= _Lx[p] * yj;
+    }
+    for (size_t j = _n; j-- > 0;) {
+      T sum = y[j];
+      for (size_t p = _Lp[j] + 1; p < _Lp[j + 1]; ++p) sum -= _Lx[p] * y[_Li[p]];
+      y[j] = sum / _Lx[_Lp[j]];
+    }
+    for (size_t k = 0; k < _n; ++k) x[_perm[k]] = y[k];
+  }
+
+  /// @brief Number of nonzeros in L (including the diagonal).
+  size_t nnz_l() const { return _Lp.empty() ? 0 : _Lp[_n]; }
+
+  /// @brief The fill-reducing permutation, perm[new] = old.
+  const std::vector<size_t>& permutation() const { return _perm; }
+};
+
+/// @brief Sparse LU factorization P A Q = L U with threshold partial pivoting (left-looking Gilbert-Peierls).
+/// analyze() fixes the column ordering Q; factorize() computes pivots and the patterns of L and U;
+/// refactorize() reuses the pivot sequence and patterns for a new matrix with the same sparsity pattern,
+/// which skips all graph traversal and is the fast path inside nonlinear iterations.
+template <typename T = double>
+class sparse_lu {
+ private:
+  size_t _n = 0;
+  std::vector<size_t> _q;                          // column order, q[k] = original column
+  std::vector<size_t> _a_row_ptr, _a_col_indices;  // pattern the analysis was done for
+  std::vector<size_t> _cp, _ci, _cpos;             // A by columns, with positions in A.values()
+  std::vector<size_t> _Lp, _Li, _Up, _Ui;          // L: original row indices, unit diagonal not stored; U: pivot-order rows
+  std::vector<T> _Lx, _Ux, _Udiag;
+  std::vector<size_t> _prow, _pinv;  // _prow[k] = original row of pivot k
+  T _pivot_tol = T(1.0);
+  bool _factorized = false;
+
+  void _check_pattern(const sparse_matrix<T>& A) const {
+    if (_n == 0 && A.rows() != 0) throw std::logic_error("sparse_lu::factorize called before analyze.");
+    if (A.rows() != _n || A.row_ptr() != _a_row_ptr || A.col_indices() != _a_col_indices) {
+      Log::Error("Sparse LU: matrix pattern differs from the analyzed one. Call analyze() again.");
+      throw std::invalid_argument("Sparsity pattern does not match the symbolic analysis.");
+    }
+  }
+
+  /// @brief Nonzero pattern of L^-1 A(:, col) in topological order, written to xi[top..n).
+  size_t _reach(size_t col, std::vector<size_t>& xi, std::vector<size_t>& stack, std::vector<size_t>& pstack,
+                std::vector<size_t>& mark, size_t stamp) const {
+    size_t top = _n;
+    for (size_t p = _cp[col]; p < _cp[col + 1]; ++p) {
+      size_t start = _ci[p];
+      if (mark[start] == stamp) continue;
+      long head = 0;
+      stack[0] = start;
+      while (head >= 0) {
+        size_t j = stack[head];
+        size_t jnew = _pinv[j];
+        if (mark[j] != stamp) {
+          mark[j] = stamp;
+          pstack[head] = (jnew == detail::npos) ? 0 : _Lp[jnew];
+        }
+        bool done = true;
+        size_t p2 = (jnew == detail::npos) ? 0 : _Lp[jnew + 1];
+        for (size_t q = pstack[head]; q < p2; ++q) {
+          size_t i = _Li[q];
+          if (mark[i] == stamp) continue;
+          pstack[head] = q + 1;
+          stack[++head] = i;
+          done = false;
+          break;
+        }
+        if (done) {
+          --head;
+          xi[--top] = j;
+        }
+      }
+    }
+    return top;
+  }
+
+ public:
+  sparse_lu() = default;
+
+  /// @brief Analyzes and factorizes A.
+  explicit sparse_lu(const sparse_matrix<T>& A, sparse_ordering ordering = sparse_ordering::amd, T pivot_tol = T(1.0)) {
+    analyze(A, ordering);
+    factorize(A, pivot_tol);
+  }
+
+  /// @brief Symbolic analysis: column ordering and column access structure of A.
+  void analyze(const sparse_matrix<T>& A, sparse_ordering ordering = sparse_ordering::amd) {
+    detail::check_square(A, "Sparse LU");
+    _n = A.rows();
+    _a_row_ptr = A.row_ptr();
+    _a_col_indices = A.col_indices();
+    _q = fill_reducing_ordering(A, ordering);
+    detail::csc_pattern<T> csc(A);
+    _cp = std::move(csc.col_ptr);
+    _ci = std::move(csc.row_idx);
+    _cpos = std::move(csc.csr_pos);
+    _factorized = false;
+  }
+
+  /// @brief Numerical factorization with threshold partial pivoting.
+  /// @param pivot_tol The diagonal entry is kept as pivot if |a_kk| >= pivot_tol * max_i |a_ik|;
+  /// 1 gives classic partial pivoting, smaller values preserve the ordering's sparsity better.
+  /// @throws std::runtime_error If the matrix is singular.
+  void factorize(const sparse_matrix<T>& A, T pivot_tol = T(1.0)) {
+    _check_pattern(A);
+    _pivot_tol = pivot_tol;
+    _factorized = false;
+    const auto& av = A.values();
+    size_t est = 2 * A.nnz() + _n;
+    _Lp.assign(_n + 1, 0);
+    _Up.assign(_n + 1, 0);
+    _Li.clear();
+    _Lx.clear();
+    _Ui.clear();
+    _Ux.clear();
+    _Li.reserve(est);
+    _Lx.reserve(est);
+    _Ui.reserve(est);
+    _Ux.reserve(est);
+    _Udiag.assign(_n, T(0.0));
+    _prow.assign(_n, detail::npos);
+    _pinv.assign(_n, detail::npos);
+
+    std::vector<T> x(_n, T(0.0));
+    std::vector<size_t> xi(_n), stack(_n), pstack(_n), mark(_n, 0);
+    for (size_t k = 0; k < _n; ++k) {
+      size_t col = _q[k];
+      size_t top = _reach(col, xi, stack, pstack, mark, k + 1);
+      for (size_t p = _cp[col]; p < _cp[col + 1]; ++p) x[_ci[p]] = av[_cpos[p]];
+
+      // Sparse triangular solve with the columns of L computed so far.
+      for (size_t t = top; t < _n; ++t) {
+        size_t j = _pinv[xi[t]];
+        if (j == detail::npos) continue;
+        T xj = x[xi[t]];
+        for (size_t p = _Lp[j]; p < _Lp[j + 1]; ++p) x[_Li[p]] -= _Lx[p] * xj;
+      }
+
+      size_t ipiv = detail::npos;
+      T amax = T(-1.0);
+      for (size_t t = top; t < _n; ++t) {
+        size_t i = xi[t];
+        if (_pinv[i] == detail::npos) {
+          if (std::abs(x[i]) > amax) {
+            amax = std::abs(x[i]);
+            ipiv = i;
+          }
+        } else {
+          _Ui.push_back(_pinv[i]);
+          _Ux.push_back(x[i]);
+        }
+      }
+      if (ipiv == detail::npos || amax <= T(0.0)) {
+        Log::Error("Matrix is singular in sparse_lu.");
+        throw std::runtime_error("Matrix is singular.");
+      }
+      if (_pinv[col] == detail::npos && mark[col] == k + 1 && std::abs(x[col]) >= pivot_tol * amax) ipiv = col;
+
+      T pivot = x[ipiv];
+      _Udiag[k] = pivot;
+      _pinv[ipiv] = k;
+      _prow[k] = ipiv;
+      for (size_t t = top; t < _n; ++t) {
+        size_t i = xi[t];
+        if (_pinv[i] == detail::npos) {
+          _Li.push_back(i);
+          _Lx.push_back(x[i] / pivot);
+        }
+        x[i] = T(0.0);
+      }
+      _Lp[k + 1] = _Li.size();
+      _Up[k + 1] = _Ui.size();
+    }
+    _factorized = true;
+  }
+
+  /// @brief Refactorizes a matrix with the same pattern, reusing the pivot order and the patterns of L and U.
+  /// Falls back to a full factorize() if a reused pivot becomes too small relative to its column.
+  void refactorize(const sparse_matrix<T>& A) {
+    _check_pattern(A);
+    if (!_factorized) {
+      factorize(A, _pivot_tol);
+      return;
+    }
+    const auto& av = A.values();
+    std::vector<T> x(_n, T(0.0));
+    for (size_t k = 0; k < _n; ++k) {
+      size_t col = _q[k];
+      for (size_t p = _cp[col]; p < _cp[col + 1]; ++p) x[_ci[p]] = av[_cpos[p]];
+      for (size_t p = _Up[k]; p < _Up[k + 1]; ++p) {
+        size_t j = _Ui[p];
+        T xj = x[_prow[j]];
+        _Ux[p] = xj;
+        x[_prow[j]] = T(0.0);
+        for (size_t q = _Lp[j]; q < _Lp[j + 1]; ++q) x[_Li[q]] -= _Lx[q] * xj;
+      }
+      T pivot = x[_prow[k]];
+      x[_prow[k]] = T(0.0);
+      T lmax = T(0.0);
+      for (size_t q = _Lp[k]; q < _Lp[k + 1]; ++q) lmax = std::max(lmax, std::abs(x[_Li[q]]));
+      if (pivot == T(0.0) || std::abs(pivot) < T(1e-3) * lmax) {
+        Log::Warn("Sparse LU refactorization: pivot became unstable, recomputing the pivot order.");
+        factorize(A, _pivot_tol);
+        return;
+      }
+      _Udiag[k] = pivot;
+      for (size_t q = _Lp[k]; q < _Lp[k + 1]; ++q) {
+        _Lx[q] = x[_Li[q]] / pivot;
+        x[_Li[q]] = T(0.0);
+      }
+    }
+  }
+
+  /// @brief Solves A x = b with the computed factors.
+  vector<T> solve(const vector<T>& b) const {
+    if (!_factorized) throw std::logic_error("sparse_lu::solve called before factorize.");
+    if (b.size() != _n) throw std::invalid_argument("Right-hand side size does not match the factorized matrix.");
+    std::vector<T> y(b.begin(), b.end());
+    std::vector<T> z(_n);
+    for (size_t j = 0; j < _n; ++j) {
+      T v = y[_prow[j]];
+      z[j] = v;
+      for (size_t p = _Lp[j]; p < _Lp[j + 1]; ++p) y[_Li[p]] -= _Lx[p] * v;
+    }
+    for (size_t k = _n; k-- > 0;) {
+      z[k] /= _Udiag[k];
+      T zk = z[k];
+      for (size_t p = _Up[k]; p < _Up[k + 1]; ++p) z[_Ui[p]] -= _Ux[p] * zk;
+    }
+    vector<T> x(_n);
+    for (size_t k = 0; k < _n; ++k) x[_q[k]] = z[k];
+    return x;
+  }
+
+  /// @brief Number of nonzeros in L (unit diagonal not counted).
+  size_t nnz_l() const { return _Li.size(); }
+
+  /// @brief Number of nonzeros in U (including the diagonal).
+  size_t nnz_u() const { return _Ui.size() + _n; }
+
+  /// @brief The column ordering, q[k] = original column.
+  const std::vector<size_t>& column_permutation() const { return _q; }
+
+  /// @brief The row pivot sequence, p[k] = original row of pivot k.
+  const std::vector<size_t>& row_permutation() const { return _prow; }
+};
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
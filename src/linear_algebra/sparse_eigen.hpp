@@ -0,0 +1,617 @@
+#pragma once
+
+#include "../common/sparse.hpp"
+#include "../common/sparse_formats.hpp"
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "krylov.hpp"
+#include "preconditioners.hpp"
+#include "sparse_direct.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Which end of the spectrum a sparse eigensolver targets.
+enum class eigen_which {
+  smallest,          // Algebraically smallest eigenvalues.
+  largest,           // Algebraically largest eigenvalues.
+  largest_magnitude  // Largest |lambda|; used internally by shift-invert.
+};
+
+/// @brief Outcome of a sparse eigensolve.
+template <typename T = double>
+struct eigen_result {
+  vector<T> values;          // Eigenvalues in ascending order.
+  tensor<T> vectors;         // n x k matrix; column i is the eigenvector of values[i].
+  int iterations = 0;        // Restarts (Lanczos) or block iterations (LOBPCG).
+  bool converged = false;    // True if every requested pair met the tolerance.
+  std::vector<T> residuals;  // ||A x_i - lambda_i x_i|| for every returned pair.
+};
+
+namespace detail {
+
+constexpr size_t eigen_tile = 256;
+
+/// @brief G = X^T Y for blocks given as column pointers (G is p x q, column-major).
+/// Rows are processed in tiles so every column segment is reused from cache for all pairs; each
+/// thread accumulates a private partial G, and partials are added in a fixed order.
+template <typename T>
+void block_gram(const std::vector<const T*>& X, const std::vector<const T*>& Y, size_t n, std::vector<T>& G) {
+  size_t p = X.size(), q = Y.size();
+  G.assign(p * q, T(0.0));
+  if (p == 0 || q == 0) return;
+  auto kernel = [&](size_t lo, size_t hi, T* out) {
+    for (size_t t0 = lo; t0 < hi; t0 += eigen_tile) {
+      size_t t1 = std::min(hi, t0 + eigen_tile);
+      for (size_t j = 0; j < q; ++j) {
+        const T* y = Y[j];
+        for (size_t i = 0; i < p; ++i) {
+          const T* x = X[i];
+          T s = T(0.0);
+          for (size_t r = t0; r < t1; ++r) s += x[r] * y[r];
+          out[i + j * p] += s;
+        }
+      }
+    }
+  };
+  size_t chunks = std::min(utility::num_threads(), std::max<size_t>(1, n * (p + q) / (size_t(1) << 16)));
+  if (chunks <= 1) {
+    kernel(0, n, G.data());
+    return;
+  }
+  std::vector<std::vector<T>> partial(chunks, std::vector<T>(p * q, T(0.0)));
+  utility::thread_pool::instance().run(chunks, [&](size_t c) { kernel(n * c / chunks, n * (c + 1) / chunks, partial[c].data()); });
+  for (const auto& part : partial) {
+    for (size_t k = 0; k < p * q; ++k) G[k] += part[k];
+  }
+}
+
+/// @brief out_j = beta * out_j + sum_i X_i C(i, j) with C p x q column-major. out must not alias X.
+template <typename T>
+void block_combine(const std::vector<const T*>& X, const T* C, const std::vector<T*>& out, size_t n, T beta) {
+  size_t p = X.size(), q = out.size();
+  utility::parallel_for(0, n, std::max<size_t>(eigen_tile, (size_t(1) << 16) / std::max<size_t>(1, p + q)), [&](size_t lo, size_t hi) {
+    for (size_t t0 = lo; t0 < hi; t0 += eigen_tile) {
+      size_t t1 = std::min(hi, t0 + eigen_tile);
+      for (size_t j = 0; j < q; ++j) {
+        T* o = out[j];
+        if (beta == T(0.0)) std::fill(o + t0, o + t1, T(0.0));
+        else if (beta != T(1.0)) for (size_t r = t0; r < t1; ++r) o[r] *= beta;
+        for (size_t i = 0; i < p; ++i) {
+          T c = C[i + j * p];
+          if (c == T(0.0)) continue;
+          const T* x = X[i];
+          for (size_t r = t0; r < t1; ++r) o[r] += c * x[r];
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+std::vector<const T*> columns(const std::vector<vector<T>>& V, size_t begin, size_t end) {
+  std::vector<const T*> c;
+  for (size_t i = begin; i < end; ++i) c.push_back(V[i].raw());
+  return c;
+}
+
+/// @brief Blocked classical Gram-Schmidt, applied twice: removes from w its components along the basis
+/// (one gram and one combine pass each). Returns the accumulated coefficients.
+template <typename T>
+std::vector<T> reorthogonalize(const std::vector<const T*>& basis, vector<T>& w) {
+  size_t n = w.size();
+  std::vector<T> h(basis.size(), T(0.0)), g;
+  if (basis.empty()) return h;
+  std::vector<const T*> wc{w.raw()};
+  std::vector<T*> wo{w.raw()};
+  for (int pass = 0; pass < 2; ++pass) {
+    block_gram(basis, wc, n, g);
+    for (auto& v : g) v = -v;
+    block_combine(basis, g.data(), wo, n, T(1.0));
+    for (size_t i = 0; i < h.size(); ++i) h[i] -= g[i];
+  }
+  return h;
+}
+
+/// @brief Eigen-decomposition of a small dense symmetric matrix (row-major, m x m) by cyclic Jacobi.
+/// Eigenvalues come out ascending, Q holds the eigenvectors as columns (column-major).
+template <typename T>
+void small_symmetric_eigen(size_t m, std::vector<T> a, std::vector<T>& w, std::vector<T>& Q) {
+  std::vector<T> q(m * m, T(0.0));
+  for (size_t i = 0; i < m; ++i) q[i * m + i] = T(1.0);
+  for (int sweep = 0; sweep < 100; ++sweep) {
+    T off = T(0.0), total = T(0.0);
+    for (size_t i = 0; i < m; ++i) {
+      for (size_t j = 0; j < m; ++j) {
+        total += a[i * m + j] * a[i * m + j];
+        if (i != j) off += a[i * m + j] * a[i * m + j];
+      }
+    }
+    if (off <= std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * total) break;
+    for (size_t p = 0; p + 1 < m; ++p) {
+      for (size_t r = p + 1; r < m; ++r) {
+        T apq = a[p * m + r];
+        if (apq == T(0.0)) continue;
+        T theta = (a[r * m + r] - a[p * m + p]) / (T(2.0) * apq);
+        T t = (theta >= T(0.0) ? T(1.0) : T(-1.0)) / (std::abs(theta) + std::sqrt(theta * theta + T(1.0)));
+        T c = T(1.0) / std::sqrt(t * t + T(1.0)), s = t * c;
+        for (size_t i = 0; i < m; ++i) {
+          T x = a[i * m + p], y = a[i * m + r];
+          a[i * m + p] = c * x - s * y;
+          a[i * m + r] = s * x + c * y;
+        }
+        for (size_t i = 0; i < m; ++i) {
+          T x = a[p * m + i], y = a[r * m + i];
+          a[p * m + i] = c * x - s * y;
+          a[r * m + i] = s * x + c * y;
+        }
+        for (size_t i = 0; i < m; ++i) {
+          T x = q[i * m + p], y = q[i * m + r];
+          q[i * m + p] = c * x - s * y;
+          q[i * m + r] = s * x + c * y;
+        }
+      }
+    }
+  }
+  std::vector<size_t> order(m);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(), [&](size_t x, size_t y) { return a[x * m + x] < a[y * m + y]; });
+  w.resize(m);
+  Q.assign(m * m, T(0.0));
+  for (size_t j = 0; j < m; ++j) {
+    w[j] = a[order[j] * m + order[j]];
+    for (size_t i = 0; i < m; ++i) Q[i + j * m] = q[i * m + order[j]];
+  }
+}
+
+/// @brief Indices of the Ritz values sorted from most to least wanted.
+template <typename T>
+std::vector<size_t> wanted_order(const std::vector<T>& theta, eigen_which which) {
+  std::vector<size_t> idx(theta.size());
+  std::iota(idx.begin(), idx.end(), size_t(0));
+  std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+    switch (which) {
+      case eigen_which::smallest: return theta[a] < theta[b];
+      case eigen_which::largest: return theta[a] > theta[b];
+      default: return std::abs(theta[a]) > std::abs(theta[b]);
+    }
+  });
+  return idx;
+}
+
+/// @brief Deterministic pseudo-random start vector.
+template <typename T>
+void random_fill(vector<T>& v, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (size_t i = 0; i < v.size(); ++i) v[i] = T(dist(gen));
+}
+
+template <typename T, typename Matrix>
+void check_eigen_problem(const Matrix& A, size_t k, const char* name) {
+  if (A.rows() != A.cols()) {
+    Log::Error(std::string(name) + " failed: operator is not square.");
+    throw std::invalid_argument("Eigensolvers require a square operator.");
+  }
+  if (k == 0 || k >= A.rows()) {
+    Log::Error(std::string(name) + " failed: requested " + std::to_string(k) + " eigenpairs of a " + std::to_string(A.rows()) + " x " +
+               std::to_string(A.rows()) + " operator.");
+    throw std::invalid_argument("Number of eigenpairs must be in [1, n).");
+  }
+}
+
+/// @brief Packs the selected Ritz pairs into an eigen_result (ascending order) with true residual norms.
+template <typename T, typename Matrix>
+eigen_result<T> pack_eigenpairs(const Matrix& A, std::vector<T> theta, std::vector<vector<T>> X) {
+  size_t k = theta.size(), n = A.rows();
+  std::vector<size_t> order(k);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return theta[a] < theta[b]; });
+  eigen_result<T> res;
+  res.values = vector<T>(k);
+  std::vector<T> flat(n * k);
+  vector<T> Ax(n);
+  for (size_t j = 0; j < k; ++j) {
+    const vector<T>& x = X[order[j]];
+    res.values[j] = theta[order[j]];
+    for (size_t i = 0; i < n; ++i) flat[i * k + j] = x[i];
+    A.multiply(x, Ax);
+    T r = T(0.0);
+    for (size_t i = 0; i < n; ++i) r += (Ax[i] - res.values[j] * x[i]) * (Ax[i] - res.values[j] * x[i]);
+    res.residuals.push_back(std::sqrt(r));
+  }
+  res.vectors = tensor<T>({n, k}, std::move(flat));
+  return res;
+}
+
+/// @brief Pairs found by one thick-restart Lanczos run.
+template <typename T>
+struct lanczos_pairs {
+  std::vector<T> values;
+  std::vector<vector<T>> vectors;
+  int restarts = 0;
+  size_t nconv = 0;
+  bool converged = false;
+};
+
+/// @brief One single-start thick-restart Lanczos run for the k most wanted pairs of A restricted to the
+/// orthogonal complement of `locked`: every new basis vector is orthogonalized against the locked vectors
+/// too. A single start vector sees only one direction of every eigenspace, so a run finds at most one copy
+/// of a repeated eigenvalue outside the locked space.
+template <typename T, typename Matrix>
+lanczos_pairs<T> lanczos_run(const Matrix& A, const std::vector<vector<T>>& locked, size_t k, eigen_which which, T tol,
+                             int max_restarts, size_t ncv, unsigned seed) {
+  size_t n = A.rows(), off = locked.size(), free = n - off;
+  size_t m = std::min(free, ncv ? std::max(ncv, k + 2) : std::max<size_t>(2 * k + 1, 20));
+  std::vector<vector<T>> V(m + 1, vector<T>(n));
+  std::vector<T> H(m * m, T(0.0));
+  vector<T> w(n);
+  // Locked vectors followed by the first `count` basis vectors (V is permuted by restarts, so rebuilt per use).
+  auto basis_cols = [&](size_t count) {
+    std::vector<const T*> c = columns(locked, 0, off);
+    for (size_t i = 0; i < count; ++i) c.push_back(V[i].raw());
+    return c;
+  };
+  random_fill(V[0], seed);
+  reorthogonalize(basis_cols(0), V[0]);
+  V[0] /= norm(V[0]);
+
+  size_t l = 0;
+  T beta = T(0.0);
+  std::vector<T> theta, Y;
+  const T eps23 = std::pow(std::numeric_limits<T>::epsilon(), T(2.0) / T(3.0));
+  for (int restart = 0;; ++restart) {
+    size_t basis = m;
+    for (size_t j = l; j < m; ++j) {
+      A.multiply(V[j], w);
+      std::vector<T> h = reorthogonalize(basis_cols(j + 1), w);
+      for (size_t i = 0; i <= j; ++i) H[i * m + j] = H[j * m + i] = h[off + i];
+      beta = norm(w);
+      if (beta <= std::numeric_limits<T>::epsilon() * std::abs(h[off + j]) || beta == T(0.0)) {
+        // Invariant subspace: continue with a fresh direction, decoupled from the current basis.
+        beta = T(0.0);
+        if (j + 1 == free) {
+          basis = j + 1;
+          break;
+        }
+        random_fill(V[j + 1], seed + static_cast<unsigned>(j + 1));
+        reorthogonalize(basis_cols(j + 1), V[j + 1]);
+        V[j + 1] /= norm(V[j + 1]);
+        continue;
+      }
+      for (size_t i = 0; i < n; ++i) V[j + 1][i] = w[i] / beta;
+    }
+
+    std::vector<T> Hb(basis * basis);
+    for (size_t i = 0; i < basis; ++i) {
+      for (size_t j = 0; j < basis; ++j) Hb[i * basis + j] = H[i * m + j];
+    }
+    small_symmetric_eigen(basis, Hb, theta, Y);
+    std::vector<size_t> order = wanted_order(theta, which);
+    T anorm = std::max(std::abs(theta.front()), std::abs(theta.back()));
+    size_t want = std::min(k, basis), nconv = 0;
+    for (size_t i = 0; i < want; ++i) {
+      size_t c = order[i];
+      T r = std::abs(beta * Y[(basis - 1) + c * basis]);
+      if (r <= tol * std::max(std::abs(theta[c]), eps23 * anorm)) ++nconv;
+    }
+    bool done = nconv == want || basis < m;
+    if (done || restart >= max_restarts) {
+      lanczos_pairs<T> run;
+      run.restarts = restart;
+      run.nconv = nconv;
+      run.converged = done;
+      std::vector<T> coeff(basis * want);
+      for (size_t j = 0; j < want; ++j) {
+        run.values.push_back(theta[order[j]]);
+        for (size_t i = 0; i < basis; ++i) coeff[i + j * basis] = Y[i + order[j] * basis];
+      }
+      run.vectors.assign(want, vector<T>(n));
+      std::vector<T*> out;
+      for (auto& x : run.vectors) out.push_back(x.raw());
+      block_combine(columns(V, 0, basis), coeff.data(), out, n, T(0.0));
+      return run;
+    }
+
+    // Thick restart: keep the most wanted Ritz vectors plus a margin, continue from V[m].
+    l = std::min(m - 1, k + (m - k) / 2);
+    std::vector<T> coeff(m * l);
+    for (size_t j = 0; j < l; ++j) {
+      for (size_t i = 0; i < m; ++i) coeff[i + j * m] = Y[i + order[j] * m];
+    }
+    std::vector<vector<T>> kept(l, vector<T>(n));
+    std::vector<T*> out;
+    for (auto& x : kept) out.push_back(x.raw());
+    block_combine(columns(V, 0, m), coeff.data(), out, n, T(0.0));
+    std::swap(V[l], V[m]);
+    for (size_t j = 0; j < l; ++j) std::swap(V[j], kept[j]);
+    std::fill(H.begin(), H.end(), T(0.0));
+    for (size_t j = 0; j < l; ++j) {
+      H[j * m + j] = theta[order[j]];
+      H[j * m + l] = H[l * m + j] = beta * Y[(m - 1) + order[j] * m];
+    }
+  }
+}
+
+}  // namespace detail
+
+/// @brief Thick-restart Lanczos (Krylov-Schur form, Wu and Simon) for k extremal eigenpairs of a symmetric
+/// operator. A can be any sparse_operator: a sparse_matrix, another sparse format, or a matrix-free type
+/// with rows(), cols() and multiply(x, y).
+///
+/// The basis is kept orthogonal with blocked classical Gram-Schmidt applied twice (two gram/combine passes
+/// over the basis per step instead of one dot product per vector). When the basis is full, the most wanted
+/// Ritz vectors are kept and the iteration continues from the last residual vector.
+///
+/// A single start vector cannot resolve repeated eigenvalues, so converged pairs are locked and the
+/// iteration is restarted from a fresh random vector orthogonal to them; this repeats until a run finds no
+/// pair more wanted than the k-th locked one. The confirming run roughly doubles the cost of a spectrum
+/// without multiplicities; lobpcg resolves repeated eigenvalues within its block at no extra cost.
+/// @param A Symmetric operator.
+/// @param k Number of eigenpairs.
+/// @param which Which end of the spectrum to compute.
+/// @param tol Convergence test ||A x - theta x|| <= tol * max(|theta|, eps^(2/3) ||A||).
+/// @param max_restarts Maximum number of restarts, summed over all runs.
+/// @param ncv Basis size; 0 picks max(2k + 1, 20).
+/// @throws std::invalid_argument If A is not square or k is not in [1, n).
+template <typename T = double, sparse_operator<T> Matrix>
+eigen_result<T> lanczos(const Matrix& A, size_t k, eigen_which which = eigen_which::smallest, T tol = T(1e-8),
+                        int max_restarts = 300, size_t ncv = 0) {
+  detail::check_eigen_problem<T>(A, k, "Lanczos");
+  size_t n = A.rows();
+  const T eps23 = std::pow(std::numeric_limits<T>::epsilon(), T(2.0) / T(3.0));
+  auto score = [&](T v) {
+    switch (which) {
+      case eigen_which::smallest: return -v;
+      case eigen_which::largest: return v;
+      default: return std::abs(v);
+    }
+  };
+
+  std::vector<T> values;
+  std::vector<vector<T>> locked;
+  int restarts = 0;
+  bool converged = true;
+  size_t want = k;
+  for (unsigned round = 0;; ++round) {
+    detail::lanczos_pairs<T> run = detail::lanczos_run(A, locked, want, which, tol, max_restarts - restarts, ncv, 1u + round * 7919u);
+    restarts += run.restarts;
+
+    // A new pair counts only if it is more wanted than the current k-th locked value by more than the
+    // tolerance, so copies of a repeated eigenvalue at the boundary do not trigger another run.
+    size_t entered = run.values.size();
+    if (locked.size() >= k) {
+      std::vector<size_t> order = detail::wanted_order(values, which);
+      T kth = values[order[k - 1]], anorm = T(0.0);
+      for (T v : values) anorm = std::max(anorm, std::abs(v));
+      T margin = tol * std::max(std::abs(kth), eps23 * anorm);
+      entered = 0;
+      for (T v : run.values) entered += score(v) > score(kth) + margin;
+    }
+    for (size_t j = 0; j < run.values.size(); ++j) {
+      values.push_back(run.values[j]);
+      locked.push_back(std::move(run.vectors[j]));
+    }
+    if (!run.converged) {
+      converged = false;
+      Log::Warn("Lanczos did not converge: " + std::to_string(run.nconv) + " of " + std::to_string(run.values.size()) + " eigenpairs.");
+      break;
+    }
+    want = entered;
+    if (want == 0 || locked.size() + want >= n) break;
+    if (restarts >= max_restarts) {
+      converged = false;
+      Log::Warn("Lanczos did not converge: restart budget exhausted before the locked pairs were confirmed.");
+      break;
+    }
+  }
+
+  std::vector<size_t> order = detail::wanted_order(values, which);
+  std::vector<T> vals(k);
+  std::vector<vector<T>> X(k);
+  for (size_t j = 0; j < k; ++j) {
+    vals[j] = values[order[j]];
+    X[j] = std::move(locked[order[j]]);
+  }
+  eigen_result<T> packed = detail::pack_eigenpairs(A, vals, std::move(X));
+  packed.iterations = restarts;
+  packed.converged = converged;
+  return packed;
+}
+
+/// @brief Locally Optimal Block Preconditioned Conjugate Gradient (Knyazev) for k extremal eigenpairs of a
+/// symmetric operator. Every iteration performs a Rayleigh-Ritz step on span{X, P, W}, where W = M R holds
+/// the preconditioned residuals of the unconverged pairs and P the previous search directions. The block
+/// is orthonormalized with blocked Gram-Schmidt, and products with the operator are computed once per new
+/// column. A good preconditioner (e.g. amg_preconditioner) makes LOBPCG much faster than Lanczos for the
+/// smallest eigenvalues.
+/// @param A Symmetric operator (any sparse_operator).
+/// @param k Number of eigenpairs.
+/// @param M Symmetric positive definite preconditioner, approximating A^-1 for the smallest eigenvalues.
+/// @param which eigen_which::smallest or eigen_which::largest.
+/// @param tol Convergence test ||A x - theta x|| <= tol * max(|theta|, eps^(2/3) ||A||).
+/// @param max_iter Maximum number of block iterations.
+/// @throws std::invalid_argument If A is not square or k is not in [1, n).
+template <typename T = double, sparse_operator<T> Matrix>
+eigen_result<T> lobpcg(const Matrix& A, size_t k, const preconditioner<T>& M, eigen_which which = eigen_which::smallest,
+                       T tol = T(1e-8), int max_iter = 500) {
+  detail::check_eigen_problem<T>(A, k, "LOBPCG");
+  size_t n = A.rows();
+  if (3 * k > n) {
+    Log::Warn("LOBPCG: 3k exceeds the problem size; use a dense eigensolver for such small problems.");
+  }
+  const T eps23 = std::pow(std::numeric_limits<T>::epsilon(), T(2.0) / T(3.0));
+
+  // Orthonormalizes cols in place against basis and among themselves; drops dependent columns.
+  auto orthonormalize = [&](const std::vector<const T*>& basis, std::vector<vector<T>>& cols) {
+    std::vector<vector<T>> kept;
+    for (auto& c : cols) {
+      T before = detail::norm(c);
+      if (before == T(0.0)) continue;
+      std::vector<const T*> all = basis;
+      for (const auto& q : kept) all.push_back(q.raw());
+      detail::reorthogonalize(all, c);
+      T after = detail::norm(c);
+      if (after <= T(1e-10) * before) continue;
+      c /= after;
+      kept.push_back(std::move(c));
+    }
+    cols = std::move(kept);
+  };
+  auto apply_block = [&](const std::vector<vector<T>>& cols) {
+    std::vector<vector<T>> out(cols.size(), vector<T>(n));
+    for (size_t j = 0; j < cols.size(); ++j) A.multiply(cols[j], out[j]);
+    return out;
+  };
+  auto ptrs = [](std::vector<vector<T>>& cols) {
+    std::vector<T*> p;
+    for (auto& c : cols) p.push_back(c.raw());
+    return p;
+  };
+
+  std::vector<vector<T>> X(k, vector<T>(n)), P;
+  for (size_t j = 0; j < k; ++j) detail::random_fill(X[j], static_cast<unsigned>(j + 1));
+  orthonormalize({}, X);
+  if (X.size() < k) {
+    Log::Error("LOBPCG failed: could not build an independent start block.");
+    throw std::runtime_error("LOBPCG initialization failed.");
+  }
+  std::vector<vector<T>> AX = apply_block(X);
+  std::vector<T> theta(k);
+  std::vector<bool> active(k, true);
+
+  eigen_result<T> res;
+  int it = 0;
+  for (;; ++it) {
+    // Rayleigh-Ritz on S = [X, P, W].
+    std::vector<vector<T>> R;
+    std::vector<T> G, vals, Y;
+    if (it > 0) {
+      for (size_t j = 0; j < k; ++j) {
+        if (!active[j]) continue;
+        vector<T> r(n), z(n);
+        for (size_t i = 0; i < n; ++i) r[i] = AX[j][i] - theta[j] * X[j][i];
+        M.apply(r, z);
+        R.push_back(std::move(z));
+      }
+    }
+    std::vector<const T*> xs = detail::columns(X, 0, k);
+    orthonormalize(xs, P);
+    std::vector<const T*> xp = xs;
+    for (const auto& p : P) xp.push_back(p.raw());
+    orthonormalize(xp, R);
+    std::vector<vector<T>> AP = apply_block(P), AR = apply_block(R);
+
+    std::vector<const T*> S = xp, AS = detail::columns(AX, 0, k);
+    for (const auto& r : R) S.push_back(r.raw());
+    for (const auto& a : AP) AS.push_back(a.raw());
+    for (const auto& a : AR) AS.push_back(a.raw());
+    size_t s = S.size();
+    detail::block_gram(S, AS, n, G);
+    std::vector<T> Gs(s * s);
+    for (size_t i = 0; i < s; ++i) {
+      for (size_t j = 0; j < s; ++j) Gs[i * s + j] = (G[i + j * s] + G[j + i * s]) / T(2.0);
+    }
+    detail::small_symmetric_eigen(s, Gs, vals, Y);
+    std::vector<size_t> order = detail::wanted_order(vals, which);
+    std::vector<T> coeff(s * k);
+    for (size_t j = 0; j < k; ++j) {
+      theta[j] = vals[order[j]];
+      for (size_t i = 0; i < s; ++i) coeff[i + j * s] = Y[i + order[j] * s];
+    }
+    std::vector<vector<T>> Xn(k, vector<T>(n)), AXn(k, vector<T>(n));
+    detail::block_combine(S, coeff.data(), ptrs(Xn), n, T(0.0));
+    detail::block_combine(AS, coeff.data(), ptrs(AXn), n, T(0.0));
+
+    // New search directions: the part of the update outside span(X).
+    std::vector<T> pcoeff((s - k) * k);
+    for (size_t j = 0; j < k; ++j) {
+      for (size_t i = k; i < s; ++i) pcoeff[(i - k) + j * (s - k)] = coeff[i + j * s];
+    }
+    std::vector<vector<T>> Pn;
+    if (s > k) {
+      Pn.assign(k, vector<T>(n));
+      detail::block_combine(std::vector<const T*>(S.begin() + k, S.end()), pcoeff.data(), ptrs(Pn), n, T(0.0));
+    }
+    X = std::move(Xn);
+    AX = std::move(AXn);
+
+    T anorm = std::max(std::abs(vals.front()), std::abs(vals.back()));
+    size_t nconv = 0;
+    P.clear();
+    for (size_t j = 0; j < k; ++j) {
+      T r2 = T(0.0);
+      for (size_t i = 0; i < n; ++i) r2 += (AX[j][i] - theta[j] * X[j][i]) * (AX[j][i] - theta[j] * X[j][i]);
+      active[j] = std::sqrt(r2) > tol * std::max(std::abs(theta[j]), eps23 * anorm);
+      if (!active[j]) ++nconv;
+      else if (!Pn.empty()) P.push_back(std::move(Pn[j]));
+    }
+    if (nconv == k || it == max_iter) {
+      res = detail::pack_eigenpairs(A, theta, std::move(X));
+      res.iterations = it;
+      res.converged = nconv == k;
+      if (!res.converged) Log::Warn("LOBPCG did not converge: " + std::to_string(nconv) + " of " + std::to_string(k) + " eigenpairs.");
+      return res;
+    }
+  }
+}
+
+/// @brief LOBPCG without preconditioning.
+template <typename T = double, sparse_operator<T> Matrix>
+eigen_result<T> lobpcg(const Matrix& A, size_t k, eigen_which which = eigen_which::smallest, T tol = T(1e-8), int max_iter = 500) {
+  return lobpcg(A, k, identity_preconditioner<T>(), which, tol, max_iter);
+}
+
+/// @brief The operator (A - sigma I)^-1, factorized once with sparse_lu. Eigenvalues of A closest to
+/// sigma become the largest-magnitude eigenvalues of this operator, which Krylov methods find quickly.
+/// A - sigma I is symmetric but usually indefinite, so the LU uses a small threshold (0.001, as in
+/// symmetric-mode UMFPACK) that keeps diagonal pivots and with them the fill of the AMD ordering.
+template <typename T = double>
+class shift_invert_operator {
+ private:
+  sparse_lu<T> _lu;
+  size_t _n;
+
+ public:
+  /// @throws std::runtime_error If A - sigma I is singular (sigma is an eigenvalue).
+  shift_invert_operator(const sparse_matrix<T>& A, T sigma) : _lu(A - sparse_matrix<T>::eye(A.rows()) * sigma, sparse_ordering::amd, T(0.001)), _n(A.rows()) {}
+
+  size_t rows() const { return _n; }
+  size_t cols() const { return _n; }
+
+  /// @brief y = (A - sigma I)^-1 x
+  void multiply(const vector<T>& x, vector<T>& y) const { y = _lu.solve(x); }
+};
+
+/// @brief The k eigenpairs of a symmetric sparse matrix closest to sigma, by Lanczos on the shift-inverted
+/// operator. Interior eigenvalues (e.g. low vibration modes with sigma = 0) converge in a few restarts.
+/// @throws std::invalid_argument If A is not square or k is not in [1, n).
+/// @throws std::runtime_error If sigma is exactly an eigenvalue.
+template <typename T = double>
+eigen_result<T> lanczos_shift_invert(const sparse_matrix<T>& A, size_t k, T sigma, T tol = T(1e-8), int max_restarts = 300) {
+  detail::check_eigen_problem<T>(A, k, "Shift-invert Lanczos");
+  shift_invert_operator<T> op(A, sigma);
+  eigen_result<T> inv = lanczos(op, k, eigen_which::largest_magnitude, tol, max_restarts);
+  size_t n = A.rows();
+  std::vector<T> lambda(k);
+  std::vector<vector<T>> X(k, vector<T>(n));
+  for (size_t j = 0; j < k; ++j) {
+    lambda[j] = sigma + T(1.0) / inv.values[j];
+    for (size_t i = 0; i < n; ++i) X[j][i] = inv.vectors(i, j);
+  }
+  eigen_result<T> res = detail::pack_eigenpairs(A, lambda, std::move(X));
+  res.iterations = inv.iterations;
+  res.converged = inv.converged;
+  return res;
+}
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
@@ -0,0 +1,331 @@
+#pragma once
+
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "blas.hpp"
+#include "factorizations.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+namespace detail {
+
+/// @brief Turns the contiguous vector x (length len) into a Householder vector: on return x[0] = beta and
+/// x[1:] holds v (v_0 = 1 implied), with (I - tau v v^T) x_original = beta e_1. Returns tau.
+template <typename T>
+T make_reflector(T* x, size_t len) {
+  if (len <= 1) return T(0.0);
+  T scale = T(0.0);
+  for (size_t i = 1; i < len; ++i) scale = std::max(scale, std::abs(x[i]));
+  if (scale == T(0.0)) return T(0.0);
+  T sum = T(0.0);
+  for (size_t i = 1; i < len; ++i) sum += (x[i] / scale) * (x[i] / scale);
+  T xnorm = scale * std::sqrt(sum);
+  T alpha = x[0];
+  T beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+  T f = T(1.0) / (alpha - beta);
+  for (size_t i = 1; i < len; ++i) x[i] *= f;
+  x[0] = beta;
+  return (beta - alpha) / beta;
+}
+
+/// @brief X[r0:r1, c0:c1] := (I - tau v v^T) X[r0:r1, c0:c1], v contiguous with v[0] = 1 implied.
+/// Column chunks are independent, so they are processed in parallel without a reduction.
+template <typename T>
+void reflect_rows(T* X, size_t ldx, size_t r0, size_t r1, size_t c0, size_t c1, const T* v, T tau) {
+  if (tau == T(0.0) || c0 >= c1) return;
+  utility::parallel_for(c0, c1, std::max<size_t>(32, (size_t(1) << 14) / (r1 - r0 + 1)), [&](size_t lo, size_t hi) {
+    std::vector<T> w(X + r0 * ldx + lo, X + r0 * ldx + hi);
+    for (size_t r = r0 + 1; r < r1; ++r) {
+      T vr = v[r - r0];
+      const T* row = X + r * ldx;
+      for (size_t c = lo; c < hi; ++c) w[c - lo] += vr * row[c];
+    }
+    for (size_t r = r0; r < r1; ++r) {
+      T f = tau * (r == r0 ? T(1.0) : v[r - r0]);
+      T* row = X + r * ldx;
+      for (size_t c = lo; c < hi; ++c) row[c] -= f * w[c - lo];
+    }
+  });
+}
+
+/// @brief X[r0:r1, c0:c1] := X[r0:r1, c0:c1] (I - tau v v^T), v contiguous with v[0] = 1 implied.
+template <typename T>
+void reflect_cols(T* X, size_t ldx, size_t r0, size_t r1, size_t c0, size_t c1, const T* v, T tau) {
+  if (tau == T(0.0) || r0 >= r1) return;
+  utility::parallel_for(r0, r1, std::max<size_t>(16, (size_t(1) << 14) / (c1 - c0 + 1)), [&](size_t lo, size_t hi) {
+    for (size_t r = lo; r < hi; ++r) {
+      T* row = X + r * ldx + c0;
+      T w = row[0];
+      for (size_t c = 1; c < c1 - c0; ++c) w += row[c] * v[c];
+      w *= tau;
+      row[0] -= w;
+      for (size_t c = 1; c < c1 - c0; ++c) row[c] -= w * v[c];
+    }
+  });
+}
+
+/// @brief Rotates rows i and j of the row-major matrix X (row length n): (x_i, x_j) <- (c x_i + s x_j, c x_j - s x_i).
+template <typename T>
+inline void rotate_rows(T* X, size_t n, size_t i, size_t j, T c, T s) {
+  T* xi = X + i * n;
+  T* xj = X + j * n;
+  for (size_t k = 0; k < n; ++k) {
+    T a = xi[k], b = xj[k];
+    xi[k] = a * c + b * s;
+    xj[k] = b * c - a * s;
+  }
+}
+
+/// @brief SVD of a square n x n matrix a (destroyed): a = U diag(sigma) V^T. Householder bidiagonalization
+/// (Golub-Kahan), then implicit-shift QR on the bidiagonal (Golub-Reinsch). The singular vectors are
+/// accumulated as the rows of Ut = U^T and Vt = V^T, so every plane rotation updates two contiguous
+/// rows. Singular values are returned in descending order. Returns false if some value did not converge.
+template <typename T>
+bool svd_square(T* a, size_t n, std::vector<T>& sigma, std::vector<T>& Ut, std::vector<T>& Vt, int max_iter) {
+  std::vector<T> d(n, T(0.0)), e(n, T(0.0));  // e[i] couples d[i - 1] and d[i]
+  std::vector<std::vector<T>> vl(n), vr(n);
+  std::vector<T> tl(n, T(0.0)), tr(n, T(0.0));
+  for (size_t k = 0; k < n; ++k) {
+    std::vector<T>& x = vl[k];
+    x.resize(n - k);
+    for (size_t i = k; i < n; ++i) x[i - k] = a[i * n + k];
+    tl[k] = make_reflector(x.data(), n - k);
+    d[k] = x[0];
+    reflect_rows(a, n, k, n, k + 1, n, x.data(), tl[k]);
+    if (k + 1 < n) {
+      std::vector<T>& y = vr[k];
+      y.assign(a + k * n + k + 1, a + (k + 1) * n);
+      tr[k] = make_reflector(y.data(), n - k - 1);
+      e[k + 1] = y[0];
+      reflect_cols(a, n, k + 1, n, k + 1, n, y.data(), tr[k]);
+    }
+  }
+  Ut.assign(n * n, T(0.0));
+  Vt.assign(n * n, T(0.0));
+  for (size_t i = 0; i < n; ++i) Ut[i * n + i] = Vt[i * n + i] = T(1.0);
+  for (size_t k = 0; k < n; ++k) reflect_rows(Ut.data(), n, k, n, 0, n, vl[k].data(), tl[k]);
+  for (size_t k = 0; k + 1 < n; ++k) reflect_rows(Vt.data(), n, k + 1, n, 0, n, vr[k].data(), tr[k]);
+
+  T anorm = T(0.0);
+  for (size_t i = 0; i < n; ++i) anorm = std::max(anorm, std::abs(d[i]) + std::abs(e[i]));
+  const T eps = std::numeric_limits<T>::epsilon();
+  bool converged = true;
+  for (size_t k = n; k-- > 0;) {
+    for (int its = 0;; ++its) {
+      // Find l such that e[l] is negligible (e[0] is always zero) or d[l - 1] is.
+      size_t l = k;
+      bool cancel = true;
+      for (;; --l) {
+        if (l == 0 || std::abs(e[l]) <= eps * anorm) {
+          cancel = false;
+          break;
+        }
+        if (std::abs(d[l - 1]) <= eps * anorm) break;
+      }
+      if (cancel) {
+        // d[l - 1] is zero: chase e[l] out with rotations from the left.
+        size_t nm = l - 1;
+        T c = T(0.0), s = T(1.0);
+        for (size_t i = l; i <= k; ++i) {
+          T f = s * e[i];
+          e[i] = c * e[i];
+          if (std::abs(f) <= eps * anorm) break;
+          T g = d[i];
+          T h = std::hypot(f, g);
+          d[i] = h;
+          c = g / h;
+          s = -f / h;
+          rotate_rows(Ut.data(), n, nm, i, c, s);
+        }
+      }
+      T z = d[k];
+      if (l == k) {
+        if (z < T(0.0)) {
+          d[k] = -z;
+          for (size_t c = 0; c < n; ++c) Vt[k * n + c] = -Vt[k * n + c];
+        }
+        break;
+      }
+      if (its == max_iter) {
+        converged = false;
+        break;
+      }
+      // Wilkinson-type shift from the trailing 2 x 2 block, then one implicit QR sweep.
+      T x = d[l];
+      size_t nm = k - 1;
+      T y = d[nm], g = e[nm], h = e[k];
+      T f = ((y - z) * (y + z) + (g - h) * (g + h)) / (T(2.0) * h * y);
+      g = std::hypot(f, T(1.0));
+      f = ((x - z) * (x + z) + h * ((y / (f + std::copysign(g, f))) - h)) / x;
+      T c = T(1.0), s = T(1.0);
+      for (size_t j = l; j <= nm; ++j) {
+        size_t i = j + 1;
+        g = e[i];
+        y = d[i];
+        h = s * g;
+        g = c * g;
+        z = std::hypot(f, h);
+        e[j] = z;
+        c = f / z;
+        s = h / z;
+        f = x * c + g * s;
+        g = g * c - x * s;
+        h = y * s;
+        y *= c;
+        rotate_rows(Vt.data(), n, j, i, c, s);
+        z = std::hypot(f, h);
+        d[j] = z;
+        if (z != T(0.0)) {
+          c = f / z;
+          s = h / z;
+        }
+        f = c * g + s * y;
+        x = c * y - s * g;
+        rotate_rows(Ut.data(), n, j, i, c, s);
+      }
+      e[l] = T(0.0);
+      e[k] = f;
+      d[k] = x;
+    }
+  }
+
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(), [&](size_t p, size_t q) { return d[p] > d[q]; });
+  std::vector<T> su(n * n), sv(n * n);
+  sigma.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    sigma[i] = d[order[i]];
+    std::copy(Ut.begin() + order[i] * n, Ut.begin() + (order[i] + 1) * n, su.begin() + i * n);
+    std::copy(Vt.begin() + order[i] * n, Vt.begin() + (order[i] + 1) * n, sv.begin() + i * n);
+  }
+  Ut.swap(su);
+  Vt.swap(sv);
+  return converged;
+}
+
+/// @brief Row-major transpose of a rows x cols block.
+template <typename T>
+tensor<T> transposed(const T* a, size_t rows, size_t cols) {
+  tensor<T> res({cols, rows});
+  T* r = res.raw();
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) r[j * rows + i] = a[i * cols + j];
+  }
+  return res;
+}
+
+}  // namespace detail
+
+/// @brief Singular Value Decomposition A = U * diag(S) * V^T (thin: with k = min(m, n), U is m x k and V
+/// is n x k). Returns {U, singular_values, V}, singular values in descending order.
+///
+/// Tall matrices are first reduced by a blocked Householder QR, A = QR. The square factor is reduced to
+/// bidiagonal form with Householder reflections (Golub-Kahan) and diagonalized with implicit-shift QR
+/// sweeps (Golub-Reinsch), so A^T A is never formed and small singular values keep full accuracy.
+/// @param A Input matrix.
+/// @param tol Optional rank truncation: singular values not above tol * max(S) are returned as exact
+/// zeros. The default 0 keeps the full spectrum; pinv, lstsq and rank apply their own thresholds.
+/// @param max_iter Maximum number of QR sweeps per singular value.
+template <typename T = double>
+std::tuple<tensor<T>, vector<T>, tensor<T>> svd(const tensor<T>& A, T tol = T(0.0), int max_iter = 100) {
+  if (A.dimensions() != 2) {
+    Log::Error("SVD failed: input must be a 2D matrix.");
+    throw std::invalid_argument("SVD requires a 2D matrix.");
+  }
+  size_t m = A.shape()[0], n = A.shape()[1];
+  if (m < n) {
+    auto [U, S, V] = svd(detail::transposed(A.raw(), m, n), tol, max_iter);
+    return {V, S, U};
+  }
+  if (n == 0) return {tensor<T>({m, n}), vector<T>(0), tensor<T>({n, n})};
+
+  qr_factorization<T> qr;
+  tensor<T> R;
+  if (m > n) {
+    qr.factorize(A);
+    R = qr.r();
+  } else {
+    R = A;
+  }
+  std::vector<T> sigma, Ut, Vt;
+  if (!detail::svd_square(R.raw(), n, sigma, Ut, Vt, max_iter)) {
+    Log::Warn("SVD: implicit QR did not converge in " + std::to_string(max_iter) + " sweeps.");
+  }
+
+  tensor<T> U({m, n});
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) U.raw()[j * n + i] = Ut[i * n + j];
+  }
+  if (m > n) U = qr.apply_q(U);
+  tensor<T> V = detail::transposed(Vt.data(), n, n);
+  vector<T> S(n);
+  for (size_t i = 0; i < n; ++i) S[i] = sigma[i] > tol * sigma[0] ? sigma[i] : T(0.0);
+  return {U, S, V};
+}
+
+/// @brief Randomized truncated SVD (Halko, Martinsson and Tropp): the k largest singular triplets of A.
+/// A Gaussian sketch Y = A * Omega captures the dominant range; a few power iterations (re-orthonormalized
+/// with QR) sharpen it for slowly decaying spectra. The small matrix B = Q^T A is then decomposed exactly.
+/// All passes over A are gemm calls, so the cost is O(mn(k + p)) instead of O(mn min(m, n)).
+/// @param A Input matrix (m x n).
+/// @param k Number of singular triplets (k <= min(m, n)).
+/// @param oversampling Extra sketch columns p, improving accuracy.
+/// @param power_iters Number of power iterations.
+/// @param seed Seed of the Gaussian test matrix.
+/// @return {U (m x k), singular values (descending), V (n x k)}.
+template <typename T = double>
+std::tuple<tensor<T>, vector<T>, tensor<T>> randomized_svd(const tensor<T>& A, size_t k, size_t oversampling = 10, int power_iters = 2,
+                                                            unsigned seed = 42) {
+  if (A.dimensions() != 2) {
+    Log::Error("Randomized SVD failed: input must be a 2D matrix.");
+    throw std::invalid_argument("SVD requires a 2D matrix.");
+  }
+  size_t m = A.shape()[0], n = A.shape()[1];
+  if (k == 0 || k > std::min(m, n)) {
+    Log::Error("Randomized SVD failed: k = " + std::to_string(k) + " is not in [1, min(m, n)].");
+    throw std::invalid_argument("Invalid number of singular triplets.");
+  }
+  size_t l = std::min(k + oversampling, std::min(m, n));
+  using blas::op;
+
+  tensor<T> omega({n, l});
+  std::mt19937 gen(seed);
+  std::normal_distribution<double> dist(0.0, 1.0);
+  for (size_t i = 0; i < omega.total_size(); ++i) omega.raw()[i] = T(dist(gen));
+
+  auto orthonormal = [](tensor<T> y) { return qr_factorization<T>(std::move(y)).q(); };
+  tensor<T> Y({m, l}), Z({n, l});
+  blas::gemm(op::none, op::none, m, l, n, T(1.0), A.raw(), n, omega.raw(), l, T(0.0), Y.raw(), l);
+  tensor<T> Q = orthonormal(std::move(Y));
+  for (int it = 0; it < power_iters; ++it) {
+    blas::gemm(op::transpose, op::none, n, l, m, T(1.0), A.raw(), n, Q.raw(), l, T(0.0), Z.raw(), l);
+    tensor<T> W = orthonormal(Z);
+    Y = tensor<T>({m, l});
+    blas::gemm(op::none, op::none, m, l, n, T(1.0), A.raw(), n, W.raw(), l, T(0.0), Y.raw(), l);
+    Q = orthonormal(std::move(Y));
+  }
+
+  tensor<T> B({l, n});
+  blas::gemm(op::transpose, op::none, l, n, m, T(1.0), Q.raw(), l, A.raw(), n, T(0.0), B.raw(), n);
+  auto [Ub, S, Vb] = svd(B, T(0.0));
+
+  tensor<T> U({m, k}), V({n, k});
+  blas::gemm(op::none, op::none, m, k, l, T(1.0), Q.raw(), l, Ub.raw(), l, T(0.0), U.raw(), k);
+  for (size_t i = 0; i < n; ++i) std::copy(Vb.raw() + i * l, Vb.raw() + i * l + k, V.raw() + i * k);
+  vector<T> Sk(k);
+  for (size_t i = 0; i < k; ++i) Sk[i] = S[i];
+  return {U, Sk, V};
+}
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
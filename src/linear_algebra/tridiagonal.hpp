@@ -0,0 +1,248 @@
+#pragma once
+
+#include "../common/tensor.hpp"
+#include "../common/vector.hpp"
+#include "../inc.hpp"
+#include "../utility/log.hpp"
+#include "../utility/parallel.hpp"
+#include "banded.hpp"
+
+namespace numc {
+namespace linear_algebra {
+
+/// @addtogroup linear_algebra
+/// @{
+
+/// @brief Thomas factorization (LU without pivoting) of an n x n tridiagonal matrix with sub[i] = A(i + 1, i),
+/// diag[i] = A(i, i) and sup[i] = A(i, i + 1). The multipliers and reciprocal pivots are kept, so each solve
+/// is two sweeps without divisions or allocation; with several right-hand sides (solve(tensor)) every step
+/// updates a contiguous row of k values, which the compiler vectorizes. Stable for diagonally dominant or
+/// symmetric positive definite matrices; use banded_lu_factorization when pivoting is needed.
+template <typename T = double>
+class tridiagonal_factorization {
+ private:
+  std::vector<T> _l;      // multipliers, _l[i] = L(i + 1, i)
+  std::vector<T> _inv_d;  // reciprocal pivots 1 / U(i, i)
+  std::vector<T> _u;      // super-diagonal of U (= sup)
+  size_t _n = 0;
+
+  void _check_rhs(size_t rows) const {
+    if (rows != _n) {
+      Log::Error("Tridiagonal solve failed: right-hand side has " + std::to_string(rows) + " rows, expected " + std::to_string(_n) + ".");
+      throw std::invalid_argument("Right-hand side size does not match the factorization.");
+    }
+  }
+
+ public:
+  tridiagonal_factorization() = default;
+
+  /// @brief Factorizes the matrix given by its three diagonals (sub and sup need at least n - 1 entries).
+  /// @throws std::runtime_error If a zero pivot is encountered.
+  tridiagonal_factorization(const vector<T>& sub, const vector<T>& diag, const vector<T>& sup) {
+    factorize(sub, diag, sup);
+  }
+
+  /// @brief Factorizes a new matrix, reusing the storage of the previous factorization.
+  void factorize(const vector<T>& sub, const vector<T>& diag, const vector<T>& sup) {
+    _n = diag.size();
+    if (_n > 0 && (sub.size() + 1 < _n || sup.size() + 1 < _n)) {
+      Log::Error("Tridiagonal factorization failed: off-diagonals must have n - 1 entries.");
+      throw std::invalid_argument("Off-diagonal size does not match the diagonal.");
+    }
+    _l.resize(_n);
+    _inv_d.resize(_n);
+    _u.resize(_n);
+    T d = _n > 0 ? diag[0] : T(1.0);
+    for (size_t i = 0; i < _n; ++i) {
+      if (d == T(0.0)) {
+        Log::Error("Tridiagonal factorization failed: zero pivot in row " + std::to_string(i) + ".");
+        throw std::runtime_error("Matrix is singular.");
+      }
+      _inv_d[i] = T(1.0) / d;
+      if (i + 1 < _n) {
+        _u[i] = sup[i];
+        _l[i] = sub[i] * _inv_d[i];
+        d = diag[i + 1] - _l[i] * sup[i];
+      }
+    }
+  }
+
+  size_t size() const { return _n; }
+
+  /// @brief Overwrites the n x k row-major block b with A^-1 b.
+  void solve_in_place(T* b, size_t k = 1) const {
+    for (size_t i = 1; i < _n; ++i) {
+      T l = _l[i - 1];
+      const T* prev = b + (i - 1) * k;
+      T* row = b + i * k;
+      for (size_t c = 0; c < k; ++c) row[c] -= l * prev[c];
+    }
+    if (_n == 0) return;
+    T* last = b + (_n - 1) * k;
+    for (size_t c = 0; c < k; ++c) last[c] *= _inv_d[_n - 1];
+    for (size_t i = _n - 1; i-- > 0;) {
+      T u = _u[i], inv = _inv_d[i];
+      const T* next = b + (i + 1) * k;
+      T* row = b + i * k;
+      for (size_t c = 0; c < k; ++c) row[c] = (row[c] - u * next[c]) * inv;
+    }
+  }
+
+  /// @brief Solves Ax = b.
+  /// @throws std::invalid_argument If b has the wrong size.
+  vector<T> solve(const vector<T>& b) const {
+    _check_rhs(b.size());
+    vector<T> x = b;
+    solve_in_place(x.raw());
+    return x;
+  }
+
+  /// @brief Solves AX = B for all columns of B (n x k) in one pass.
+  /// @throws std::invalid_argument If B does not have n rows.
+  tensor<T> solve(const tensor<T>& b) const {
+    if (b.dimensions() != 2) {
+      Log::Error("Tridiagonal solve failed: right-hand side must be a 2D matrix.");
+      throw std::invalid_argument("Right-hand side must be a matrix.");
+    }
+    _check_rhs(b.shape()[0]);
+    tensor<T> x = b;
+    solve_in_place(x.raw(), b.shape()[1]);
+    return x;
+  }
+};
+
+/// @brief Solves `batch` independent n x n tridiagonal systems stored interleaved: entry i of system s is at
+/// index i * batch + s of sub, diag, sup and b (sub[s] and sup[(n - 1) * batch + s] are ignored). Each
+/// Thomas step then runs over consecutive systems in SIMD lanes, and groups of systems are distributed over
+/// the thread pool. b is overwritten with the solutions. No pivoting (see tridiagonal_factorization).
+/// @throws std::runtime_error If some system has a zero pivot.
+template <typename T>
+void tridiagonal_solve_batched(size_t n, size_t batch, const T* sub, const T* diag, const T* sup, T* b) {
+  if (n == 0 || batch == 0) return;
+  std::atomic<bool> singular{false};
+  utility::parallel_for(0, batch, 256, [&](size_t lo, size_t hi) {
+    size_t w = hi - lo;
+    std::vector<T> cp(n * w), inv(w);
+    for (size_t s = 0; s < w; ++s) {
+      T d = diag[lo + s];
+      if (d == T(0.0)) singular = true;
+      inv[s] = T(1.0) / d;
+      cp[s] = n > 1 ? sup[lo + s] * inv[s] : T(0.0);
+      b[lo + s] *= inv[s];
+    }
+    for (size_t i = 1; i < n; ++i) {
+      size_t off = i * batch + lo;
+      const T* a = sub + off;
+      const T* d = diag + off;
+      const T* c = sup + off;
+      T* x = b + off;
+      const T* xp = b + off - batch;
+      T* ci = cp.data() + i * w;
+      const T* cprev = ci - w;
+      for (size_t s = 0; s < w; ++s) {
+        T denom = d[s] - a[s] * cprev[s];
+        if (denom == T(0.0)) singular = true;
+        T r = T(1.0) / denom;
+        ci[s] = i + 1 < n ? c[s] * r : T(0.0);
+        x[s] = (x[s] - a[s] * xp[s]) * r;
+      }
+    }
+    for (size_t i = n - 1; i-- > 0;) {
+      T* x = b + i * batch + lo;
+      const T* xn = x + batch;
+      const T* ci = cp.data() + i * w;
+      for (size_t s = 0; s < w; ++s) x[s] -= ci[s] * xn[s];
+    }
+  });
+  if (singular) {
+    Log::Error("Batched tridiagonal solve failed: zero pivot.");
+    throw std::runtime_error("Matrix is singular.");
+  }
+}
+
+/// @brief Solves one large tridiagonal system Ax = b in parallel with the SPIKE partitioning: every thread
+/// eliminates its own block of rows, solving for the local right-hand side and for the two coupling
+/// columns at once, the 2p interface unknowns are found from a small banded system, and the blocks are
+/// completed independently. About 2.5x the flops of a Thomas sweep, so it only pays off with several threads;
+/// small systems fall back to tridiagonal_factorization. No pivoting inside blocks (diagonal dominance is
+/// assumed).
+/// @throws std::runtime_error If a zero pivot is encountered.
+template <typename T = double>
+vector<T> tridiagonal_solve_parallel(const vector<T>& sub, const vector<T>& diag, const vector<T>& sup, const vector<T>& b) {
+  constexpr size_t min_block = size_t(1) << 13;
+  size_t n = diag.size();
+  if (b.size() != n || (n > 0 && (sub.size() + 1 < n || sup.size() + 1 < n))) {
+    Log::Error("Parallel tridiagonal solve failed: diagonals and right-hand side sizes do not match.");
+    throw std::invalid_argument("Tridiagonal system size mismatch.");
+  }
+  size_t p = std::min(utility::num_threads(), n / min_block);
+  if (p <= 1) return tridiagonal_factorization<T>(sub, diag, sup).solve(b);
+
+  // Columns: y = A_b^-1 r_b, v = A_b^-1 (-A(s, s - 1) e_first), w = A_b^-1 (-A(e - 1, e) e_last).
+  std::vector<T> y(n), v(n), w(n), cp(n);
+  std::atomic<bool> singular{false};
+  utility::thread_pool::instance().run(p, [&](size_t blk) {
+    size_t s = n * blk / p, e = n * (blk + 1) / p;
+    T d = diag[s];
+    if (d == T(0.0)) singular = true;
+    T r = T(1.0) / d;
+    cp[s] = e - s > 1 ? sup[s] * r : T(0.0);
+    y[s] = b[s] * r;
+    v[s] = blk > 0 ? -sub[s - 1] * r : T(0.0);
+    w[s] = e - s == 1 && blk + 1 < p ? -sup[e - 1] * r : T(0.0);
+    for (size_t i = s + 1; i < e; ++i) {
+      T a = sub[i - 1];
+      T denom = diag[i] - a * cp[i - 1];
+      if (denom == T(0.0)) singular = true;
+      r = T(1.0) / denom;
+      cp[i] = i + 1 < e ? sup[i] * r : T(0.0);
+      y[i] = (b[i] - a * y[i - 1]) * r;
+      v[i] = -a * v[i - 1] * r;
+      w[i] = (i + 1 == e && blk + 1 < p ? -sup[e - 1] : T(0.0)) * r;
+    }
+    for (size_t i = e - 1; i-- > s;) {
+      y[i] -= cp[i] * y[i + 1];
+      v[i] -= cp[i] * v[i + 1];
+      w[i] -= cp[i] * w[i + 1];
+    }
+  });
+  if (singular) {
+    Log::Error("Parallel tridiagonal solve failed: zero pivot.");
+    throw std::runtime_error("Matrix is singular.");
+  }
+
+  // Interface unknowns [first_0, last_0, first_1, last_1, ...]: x_i = y_i + v_i last_(b-1) + w_i first_(b+1).
+  banded_matrix<T> R(2 * p, 2, 2);
+  vector<T> rhs(2 * p);
+  for (size_t blk = 0; blk < p; ++blk) {
+    size_t s = n * blk / p, e = n * (blk + 1) / p;
+    size_t f = 2 * blk, l = f + 1;
+    R(f, f) = T(1.0);
+    R(l, l) = T(1.0);
+    rhs[f] = y[s];
+    rhs[l] = y[e - 1];
+    if (blk > 0) {
+      R(f, f - 1) = -v[s];
+      R(l, f - 1) = -v[e - 1];
+    }
+    if (blk + 1 < p) {
+      R(f, f + 2) = -w[s];
+      R(l, f + 2) = -w[e - 1];
+    }
+  }
+  vector<T> z = banded_lu_factorization<T>(R).solve(rhs);
+
+  vector<T> x(n);
+  utility::thread_pool::instance().run(p, [&](size_t blk) {
+    size_t s = n * blk / p, e = n * (blk + 1) / p;
+    T left = blk > 0 ? z[2 * blk - 1] : T(0.0);
+    T right = blk + 1 < p ? z[2 * blk + 2] : T(0.0);
+    for (size_t i = s; i < e; ++i) x[i] = y[i] + v[i] * left + w[i] * right;
+  });
+  return x;
+}
+
+/// @}
+
+}  // namespace linear_algebra
+}  // namespace numc
@@ -4,6 +4,7 @@
 #include "../common/tensor.hpp"
 #include "../linear_algebra/eigen.hpp"
 #include "../linear_algebra/matrix_ops.hpp"
+#include "../linear_algebra/svd.hpp"
 #include "../statistics/stats.hpp"
 #include "../inc.hpp"
 #include "../utility/log.hpp"
@@ -23,7 +24,11 @@ struct PCAResult {
 };
 
 /// @brief Principal Component Analysis (PCA).
-/// Performs linear dimensionality reduction using covariance matrix eigenvalue decomposition.
+/// Performs linear dimensionality reduction. When there are at least as many samples as features, the
+/// covariance matrix is formed with one gemm and diagonalized with eigh. Otherwise the SVD of the centered
+/// data matrix X is used: the principal axes are the right singular vectors and the variances are
+/// sigma^2 / (n_samples - 1). When only a few components of a large data set are requested, the
+/// randomized truncated SVD is used instead of a full decomposition.
 /// @tparam T Floating-point type.
 /// @param data A vector of points (each point is a vector<T>), shape: (n_samples, n_features).
 /// @param n_components Number of components to keep.
@@ -42,75 +47,79 @@ PCAResult<T> pca(
   }
 
   // 1. Center the data (subtract mean)
-  std::vector<vector<T>> centered_data = data;
   vector<T> means(n_features);
-  for (size_t j = 0; j < n_features; ++j) {
-    T sum = T(0.0);
-    for (size_t i = 0; i < n_samples; ++i) {
-      sum += data[i][j];
+  for (size_t i = 0; i < n_samples; ++i) {
+    for (size_t j = 0; j < n_features; ++j) {
+      means[j] += data[i][j];
     }
-    means[j] = sum / T(n_samples);
   }
+  means /= T(n_samples);
 
+  tensor<T> X({n_samples, n_features});
   for (size_t i = 0; i < n_samples; ++i) {
     for (size_t j = 0; j < n_features; ++j) {
-      centered_data[i][j] -= means[j];
+      X.raw()[i * n_features + j] = data[i][j] - means[j];
     }
   }
 
-  // 2. Compute Covariance Matrix (n_features x n_features)
-  // To use existing cov_matrix which takes variables as vectors, we need to transpose the data format.
-  // Actually, we can just build it directly here:
-  tensor<T> cov({n_features, n_features});
-  for (size_t j1 = 0; j1 < n_features; ++j1) {
-    for (size_t j2 = j1; j2 < n_features; ++j2) {
-      T sum = T(0.0);
-      for (size_t i = 0; i < n_samples; ++i) {
-        sum += centered_data[i][j1] * centered_data[i][j2];
+  size_t min_dim = std::min(n_samples, n_features);
+  bool truncated = min_dim >= 200 && n_components > 0 && n_components * 5 <= min_dim;
+  tensor<T> components({n_components, n_features});
+  vector<T> expl_var(n_components);
+  std::vector<vector<T>> transformed(n_samples, vector<T>(n_components));
+
+  if (!truncated && n_samples >= n_features) {
+    // 2. Few features: eigendecomposition of the n_features x n_features covariance matrix
+    T scale = T(1.0) / T(n_samples > 1 ? n_samples - 1 : 1);
+    tensor<T> C({n_features, n_features});
+    linear_algebra::blas::gemm(linear_algebra::blas::op::transpose, linear_algebra::blas::op::none, n_features,
+                               n_features, n_samples, scale, X.raw(), n_features, X.raw(), n_features, T(0.0),
+                               C.raw(), n_features);
+    auto [lam, W] = linear_algebra::eigh(std::move(C));
+
+    // 3. Select top n_components (eigenvalues are in ascending order)
+    for (size_t i = 0; i < n_components; ++i) {
+      size_t col = n_features - 1 - i;
+      expl_var[i] = std::max(lam[col], T(0.0));
+      for (size_t j = 0; j < n_features; ++j) {
+        components.raw()[i * n_features + j] = W.raw()[j * n_features + col];
       }
-      cov(j1, j2) = sum / T(n_samples - 1);
-      cov(j2, j1) = cov(j1, j2);
     }
-  }
 
-  // 3. Eigendecomposition of covariance matrix
-  // Jacobi method works for symmetric positive semi-definite matrices
-  auto [eigenvalues, eigenvectors] = numc::linear_algebra::jacobi(cov);
-
-  // 4. Sort eigenvalues and eigenvectors in descending order
-  std::vector<std::pair<T, vector<T>>> eigen_pairs(n_features);
-  for (size_t j = 0; j < n_features; ++j) {
-    vector<T> col(n_features);
-    for (size_t i = 0; i < n_features; ++i) {
-      col[i] = eigenvectors(i, j);
+    // 4. Transform the data: X * components^T
+    tensor<T> Y({n_samples, n_components});
+    linear_algebra::blas::gemm(linear_algebra::blas::op::none, linear_algebra::blas::op::transpose, n_samples,
+                               n_components, n_features, T(1.0), X.raw(), n_features, components.raw(), n_features,
+                               T(0.0), Y.raw(), n_components);
+    for (size_t i = 0; i < n_samples; ++i) {
+      for (size_t j = 0; j < n_components; ++j) transformed[i][j] = Y.raw()[i * n_components + j];
     }
-    eigen_pairs[j] = {eigenvalues[j], col};
+    return {components, expl_var, transformed};
   }
 
-  std::sort(eigen_pairs.begin(), eigen_pairs.end(),
-      [](const std::pair<T, vector<T>>& a, const std::pair<T, vector<T>>& b) {
-        return a.first > b.first;
-      });
+  // 2. Singular value decomposition X = U S V^T (truncated when few components are needed)
+  auto [U, S, V] = truncated ? numc::linear_algebra::randomized_svd(X, n_components, 10, 4)
+                             : numc::linear_algebra::svd(X, T(0.0));
+  size_t k = S.size();
+  if (n_components > k) {
+    components = tensor<T>({k, n_features});
+    expl_var = vector<T>(k);
+    transformed.assign(n_samples, vector<T>(k));
+    n_components = k;
+  }
 
-  // 5. Select top n_components
-  tensor<T> components({n_components, n_features});
-  vector<T> expl_var(n_components);
+  // 3. Select top n_components (singular values are already in descending order)
   for (size_t i = 0; i < n_components; ++i) {
-    expl_var[i] = eigen_pairs[i].first;
+    expl_var[i] = S[i] * S[i] / T(n_samples > 1 ? n_samples - 1 : 1);
     for (size_t j = 0; j < n_features; ++j) {
-      components(i, j) = eigen_pairs[i].second[j];
+      components.raw()[i * n_features + j] = V.raw()[j * k + i];
     }
   }
 
-  // 6. Transform the data (centered_data * components^T)
-  std::vector<vector<T>> transformed(n_samples, vector<T>(n_components));
+  // 4. Transform the data: X * components^T = U_k * S_k
   for (size_t i = 0; i < n_samples; ++i) {
     for (size_t j = 0; j < n_components; ++j) {
-      T sum = T(0.0);
-      for (size_t k = 0; k < n_features; ++k) {
-        sum += centered_data[i][k] * components(j, k);
-      }
-      transformed[i][j] = sum;
+      transformed[i][j] = U.raw()[i * k + j] * S[j];
     }
   }
 
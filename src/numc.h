@@ -23,15 +23,27 @@
 #include "common/function.hpp"
 #include "common/polynomial.hpp"
 #include "common/sparse.hpp"
+#include "common/sparse_formats.hpp"
 #include "common/tensor.hpp"
 #include "common/vector.hpp"
 #include "common/dataframe.hpp"
 
 // Linear Algebra
 
+#include "linear_algebra/blas.hpp"
+#include "linear_algebra/factorizations.hpp"
+#include "linear_algebra/banded.hpp"
+#include "linear_algebra/tridiagonal.hpp"
 #include "linear_algebra/solvers.hpp"
 #include "linear_algebra/eigen.hpp"
 #include "linear_algebra/matrix_ops.hpp"
+#include "linear_algebra/svd.hpp"
+#include "linear_algebra/preconditioners.hpp"
+#include "linear_algebra/linear_operator.hpp"
+#include "linear_algebra/krylov.hpp"
+#include "linear_algebra/sparse_direct.hpp"
+#include "linear_algebra/amg.hpp"
+#include "linear_algebra/sparse_eigen.hpp"
 
 // Analysis
 
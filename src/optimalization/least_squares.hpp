@@ -53,6 +53,84 @@ vector<T> gauss_newton(
   return beta;
 }
 
+/// @brief Gauss-Newton with Broyden updates of the Jacobian, for residuals whose Jacobian is expensive
+/// (e.g. computed by finite differences). The Jacobian is evaluated at the start and again only when a
+/// step fails to reduce the sum of squares; in between it is corrected by the rank-1 secant update
+/// J += (r_new - r - J s) s^T / (s^T s), at O(mn) per step. A failing step with a fresh Jacobian is halved.
+/// @tparam T Floating-point type.
+/// @param residuals Function that returns the vector of residuals: r(beta) = y - f(x, beta).
+/// @param jacobian Function that returns the Jacobian matrix J_ij = dr_i / dbeta_j.
+/// @param beta0 Initial guess for the parameters.
+/// @param tol Error tolerance on the step length.
+/// @param max_iter Maximum number of iterations.
+/// @return The optimized parameter vector.
+template <typename T = double>
+vector<T> gauss_newton_broyden(
+    std::function<vector<T>(const vector<T>&)> residuals,
+    std::function<tensor<T>(const vector<T>&)> jacobian,
+    vector<T> beta0,
+    T tol = T(1e-6),
+    int max_iter = 100) {
+  vector<T> beta = beta0;
+  vector<T> r = residuals(beta);
+  T error = r * r;
+  tensor<T> J = jacobian(beta);
+  size_t m = J.shape()[0], n = J.shape()[1];
+  bool fresh = true;
+
+  for (int iter = 0; iter < max_iter; ++iter) {
+    tensor<T> JT = numc::linear_algebra::transpose(J);
+    tensor<T> JTJ = numc::linear_algebra::matmul(JT, J);
+    vector<T> neg_JTr = numc::linear_algebra::matvec(JT, r) * T(-1.0);
+    vector<T> delta = numc::linear_algebra::gauss_elimin(JTJ, neg_JTr);
+
+    if (delta.norm() < tol) {
+      return beta + delta;
+    }
+
+    vector<T> beta_new = beta + delta;
+    vector<T> r_new = residuals(beta_new);
+    T error_new = r_new * r_new;
+
+    if (!(error_new < error)) {
+      if (!fresh) {
+        // The secant model has gone stale: re-evaluate the Jacobian here and retry.
+        J = jacobian(beta);
+        fresh = true;
+        continue;
+      }
+      T lambda = T(1.0);
+      for (int ls = 0; ls < 30 && !(error_new < error); ++ls) {
+        lambda *= T(0.5);
+        beta_new = beta + delta * lambda;
+        r_new = residuals(beta_new);
+        error_new = r_new * r_new;
+      }
+      if (!(error_new < error)) {
+        Log::Warn("Gauss-Newton (Broyden) stalled: no decrease along the Gauss-Newton direction.");
+        return beta;
+      }
+    }
+
+    vector<T> s = beta_new - beta;
+    vector<T> y = r_new - r;
+    T ss = s * s;
+    for (size_t i = 0; i < m; ++i) {
+      T js = T(0.0);
+      for (size_t j = 0; j < n; ++j) js += J(i, j) * s[j];
+      T c = (y[i] - js) / ss;
+      for (size_t j = 0; j < n; ++j) J(i, j) += c * s[j];
+    }
+    beta = beta_new;
+    r = r_new;
+    error = error_new;
+    fresh = false;
+  }
+
+  Log::Warn("Gauss-Newton (Broyden) did not converge within the maximum iterations.");
+  return beta;
+}
+
 /// @brief Levenberg-Marquardt algorithm for robust non-linear least squares.
 /// Interpolates between Gauss-Newton and Gradient Descent.
 /// @tparam T Floating-point type.
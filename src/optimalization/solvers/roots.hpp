@@ -2,6 +2,7 @@
 
 #include "../../common/function.hpp"
 #include "../../common/complex.hpp"
+#include "../../linear_algebra/krylov.hpp"
 #include "../../linear_algebra/solvers.hpp"
 #include "../../inc.hpp"
 #include "../../utility/log.hpp"
@@ -432,6 +433,8 @@ T newton_raphson(const numc::func<T>& f, const numc::func<T>& df, T a, T b, T to
 }
 
 /// @brief Multidimensional Newton-Raphson for systems of equations.
+/// Forms the full finite-difference Jacobian and solves it densely every step, so it is meant for small
+/// systems; see newton_krylov for large ones.
 template <typename T = double>
 vector<T> newton_raphson2(std::function<vector<T>(const vector<T>&)> f, vector<T> x, T tol = T(1e-9)) {
   size_t n = x.size();
@@ -459,7 +462,7 @@ vector<T> newton_raphson2(std::function<vector<T>(const vector<T>&)> f, vector<T
       return x;
     }
 
-    vector<T> minus_f0 = -f0;
+    vector<T> minus_f0 = f0 * T(-1.0);
     vector<T> dx = linear_algebra::gauss_pivot(jac, minus_f0);
     x = x + dx;
 
@@ -473,6 +476,357 @@ vector<T> newton_raphson2(std::function<vector<T>(const vector<T>&)> f, vector<T
   return x;
 }
 
+/// @brief Settings of newton_krylov.
+template <typename T = double>
+struct newton_krylov_options {
+  T tol = T(1e-9);          // Stop when ||F(x)|| / sqrt(n) < tol.
+  int max_iter = 50;        // Maximum number of Newton steps.
+  size_t restart = 30;      // GMRES restart length.
+  int max_krylov = 300;     // GMRES iterations allowed per Newton step.
+  T eta_max = T(0.9);       // Upper bound (and initial value) of the forcing term.
+  T eta_gamma = T(0.9);     // Eisenstat-Walker: eta_k = gamma (||F_k|| / ||F_(k-1)||)^2.
+  int max_backtracks = 20;  // Line search reductions before giving up.
+};
+
+/// @brief Outcome of newton_krylov.
+template <typename T = double>
+struct newton_krylov_result {
+  vector<T> x;                // Approximate root.
+  T residual = T(0.0);        // ||F(x)||.
+  int iterations = 0;         // Newton steps taken.
+  int linear_iterations = 0;  // GMRES iterations summed over all steps.
+  bool converged = false;     // True if the tolerance was reached.
+};
+
+namespace detail {
+
+/// @brief Inexact Newton loop shared by the newton_krylov overloads. jv(x, fx, v, y) computes y = J(x) v.
+template <typename T, typename F, typename Jv>
+newton_krylov_result<T> newton_krylov(const F& f,
+                                      const Jv& jv,
+                                      const vector<T>& x0,
+                                      const linear_algebra::preconditioner<T>& M,
+                                      const newton_krylov_options<T>& opt) {
+  size_t n = x0.size();
+  newton_krylov_result<T> res;
+  res.x = x0;
+  vector<T> fx = f(res.x);
+  if (fx.size() != n) {
+    Log::Error("newton_krylov failed: F must map R^n to R^n.");
+    throw std::invalid_argument("Function output size does not match the number of unknowns.");
+  }
+  res.residual = fx.norm();
+  T stop = opt.tol * std::sqrt(T(n));
+  T eta = opt.eta_max;
+  vector<T> rhs(n), trial(n);
+
+  auto J = linear_algebra::make_operator<T>(n, [&](const vector<T>& v, vector<T>& y) { jv(res.x, fx, v, y); });
+
+  for (; res.iterations < opt.max_iter; ++res.iterations) {
+    if (res.residual < stop) {
+      res.converged = true;
+      return res;
+    }
+
+    // Inexact Newton step: ||F + J d|| <= eta ||F||.
+    linear_algebra::detail::axpby(T(-1.0), fx, T(0.0), rhs);
+    // Stopping at opt.max_krylov is expected with a loose forcing term, so the inner solve runs quietly.
+    auto lin = linear_algebra::detail::gmres(J, rhs, M, opt.restart, eta, opt.max_krylov, true);
+    res.linear_iterations += lin.iterations;
+    const vector<T>& d = lin.x;
+    T achieved = std::min(lin.residuals.back(), T(1.0));
+
+    // Backtracking on ||F|| with a safeguarded quadratic model of ||F(x + lambda d)||^2.
+    T lambda = T(1.0), f_old = res.residual, f_new;
+    vector<T> f_trial;
+    for (int ls = 0;; ++ls) {
+      for (size_t i = 0; i < n; ++i) trial[i] = res.x[i] + lambda * d[i];
+      f_trial = f(trial);
+      f_new = f_trial.norm();
+      if (f_new <= (T(1.0) - T(1e-4) * lambda * (T(1.0) - achieved)) * f_old) break;
+      if (ls == opt.max_backtracks) {
+        Log::Warn("Line search failed in newton_krylov.");
+        return res;
+      }
+      T f2 = f_old * f_old;
+      T model = f2 * lambda * lambda / (f_new * f_new - f2 + T(2.0) * f2 * lambda);
+      lambda = std::clamp(model, T(0.1) * lambda, T(0.5) * lambda);
+    }
+    std::swap(res.x, trial);
+    fx = std::move(f_trial);
+    res.residual = f_new;
+
+    // Eisenstat-Walker choice 2, with the safeguards against a premature drop and against oversolving.
+    T ratio = f_new / f_old;
+    T eta_new = opt.eta_gamma * ratio * ratio;
+    T eta_prev = opt.eta_gamma * eta * eta;
+    if (eta_prev > T(0.1)) eta_new = std::max(eta_new, eta_prev);
+    eta = std::min(opt.eta_max, std::max(eta_new, T(0.5) * stop / f_new));
+  }
+  if (res.residual < stop) {
+    res.converged = true;
+    return res;
+  }
+  Log::Warn("Too many iterations in newton_krylov.");
+  return res;
+}
+
+}  // namespace detail
+
+/// @brief Jacobian-free Newton-Krylov solver for large nonlinear systems F(x) = 0.
+/// Every Newton correction is found with right-preconditioned GMRES, whose products J(x) v are directional
+/// differences (F(x + h v) - F(x)) / h with h = sqrt(eps (1 + ||x||)) / ||v||, so the Jacobian is never
+/// formed. The linear solves are inexact, with the Eisenstat-Walker forcing term, and each step is
+/// globalized by a backtracking line search on ||F||.
+/// @param f The function F: R^n -> R^n.
+/// @param x0 The initial guess.
+/// @param M Preconditioner approximating J, e.g. ilu0_preconditioner of the linear part of a discretized PDE.
+/// @param opt Tolerances and iteration limits.
+template <typename T = double, typename F>
+newton_krylov_result<T> newton_krylov(const F& f,
+                                      const vector<T>& x0,
+                                      const linear_algebra::preconditioner<T>& M,
+                                      const newton_krylov_options<T>& opt = {}) {
+  vector<T> xp(x0.size());
+  T sqrt_eps = std::sqrt(std::numeric_limits<T>::epsilon());
+  auto jv = [&](const vector<T>& x, const vector<T>& fx, const vector<T>& v, vector<T>& y) {
+    T v_norm = v.norm();
+    if (v_norm == T(0.0)) {
+      std::fill(y.begin(), y.end(), T(0.0));
+      return;
+    }
+    T h = sqrt_eps * std::sqrt(T(1.0) + x.norm()) / v_norm;
+    for (size_t i = 0; i < x.size(); ++i) xp[i] = x[i] + h * v[i];
+    vector<T> fp = f(xp);
+    for (size_t i = 0; i < y.size(); ++i) y[i] = (fp[i] - fx[i]) / h;
+  };
+  return detail::newton_krylov(f, jv, x0, M, opt);
+}
+
+/// @brief Jacobian-free Newton-Krylov without preconditioning.
+template <typename T = double, typename F>
+newton_krylov_result<T> newton_krylov(const F& f, const vector<T>& x0, const newton_krylov_options<T>& opt = {}) {
+  return newton_krylov(f, x0, linear_algebra::identity_preconditioner<T>(), opt);
+}
+
+/// @brief Newton-Krylov with exact Jacobian-vector products jv(x, v) = J(x) v, e.g. from forward-mode
+/// automatic differentiation (numc::jvp) or a hand-coded linearization, instead of directional differences.
+/// @param f The function F: R^n -> R^n.
+/// @param jv The Jacobian-vector product.
+/// @param x0 The initial guess.
+/// @param M Preconditioner approximating J.
+/// @param opt Tolerances and iteration limits.
+template <typename T = double, typename F, typename Jv>
+  requires std::is_invocable_r_v<vector<T>, const Jv&, const vector<T>&, const vector<T>&>
+newton_krylov_result<T> newton_krylov(const F& f,
+                                      const Jv& jv,
+                                      const vector<T>& x0,
+                                      const linear_algebra::preconditioner<T>& M,
+                                      const newton_krylov_options<T>& opt = {}) {
+  auto exact = [&](const vector<T>& x, const vector<T>&, const vector<T>& v, vector<T>& y) { y = jv(x, v); };
+  return detail::newton_krylov(f, exact, x0, M, opt);
+}
+
+/// @brief Newton-Krylov with exact Jacobian-vector products, without preconditioning.
+template <typename T = double, typename F, typename Jv>
+  requires std::is_invocable_r_v<vector<T>, const Jv&, const vector<T>&, const vector<T>&>
+newton_krylov_result<T> newton_krylov(const F& f, const Jv& jv, const vector<T>& x0, const newton_krylov_options<T>& opt = {}) {
+  return newton_krylov(f, jv, x0, linear_algebra::identity_preconditioner<T>(), opt);
+}
+
+/// @brief Secant update used by broyden.
+enum class broyden_update {
+  good,  // Least change to the Jacobian approximation B (Broyden's first method); usually the more robust.
+  bad    // Least change to the inverse approximation H (Broyden's second method); cheaper per update.
+};
+
+/// @brief Settings of broyden.
+template <typename T = double>
+struct broyden_options {
+  T tol = T(1e-9);                               // Stop when ||F(x)|| / sqrt(n) < tol.
+  int max_iter = 200;                            // Maximum number of steps.
+  broyden_update update = broyden_update::good;  // Secant update formula.
+  size_t memory = 0;                             // Rank-1 corrections kept before restarting from H0 (0: no limit).
+  T stall_ratio = T(0.9);                        // A step that does not bring ||F|| below this fraction stalls.
+  int max_backtracks = 20;                       // Line search reductions allowed with a fresh H0.
+};
+
+/// @brief Outcome of broyden.
+template <typename T = double>
+struct broyden_result {
+  vector<T> x;                   // Approximate root.
+  T residual = T(0.0);           // ||F(x)||.
+  int iterations = 0;            // Steps taken.
+  int jacobian_evaluations = 0;  // Times H0 was rebuilt.
+  bool converged = false;        // True if the tolerance was reached.
+};
+
+namespace detail {
+
+/// @brief Forward-difference Jacobian of f at x, given fx = f(x): n evaluations of f.
+template <typename T, typename F>
+tensor<T> fd_jacobian(const F& f, const vector<T>& x, const vector<T>& fx) {
+  size_t n = x.size();
+  tensor<T> jac({fx.size(), n});
+  vector<T> xp = x;
+  T sqrt_eps = std::sqrt(std::numeric_limits<T>::epsilon());
+  for (size_t j = 0; j < n; ++j) {
+    T h = sqrt_eps * std::max(std::abs(x[j]), T(1.0));
+    xp[j] = x[j] + h;
+    h = xp[j] - x[j];
+    vector<T> f1 = f(xp);
+    xp[j] = x[j];
+    for (size_t i = 0; i < fx.size(); ++i) jac(i, j) = (f1[i] - fx[i]) / h;
+  }
+  return jac;
+}
+
+/// @brief Quasi-Newton loop shared by the broyden overloads. The inverse Jacobian is approximated by
+/// H = H0 + rank-1 corrections kept as vector pairs (p, q): good Broyden in product form,
+/// H_(k+1) = (I + p q^T) H_k, bad Broyden in additive form, H_(k+1) = H_k + p q^T, so neither needs H0^T and
+/// applying H costs one H0 solve plus O(n k). refresh(x, fx) rebuilds H0 at x and apply0(r, z) computes z = H0 r.
+template <typename T, typename F, typename Refresh, typename Apply>
+broyden_result<T> broyden(const F& f, const Refresh& refresh, const Apply& apply0, const vector<T>& x0, const broyden_options<T>& opt) {
+  using linear_algebra::detail::axpby;
+  using linear_algebra::detail::dot;
+  size_t n = x0.size();
+  broyden_result<T> res;
+  res.x = x0;
+  vector<T> fx = f(res.x);
+  if (fx.size() != n) {
+    Log::Error("broyden failed: F must map R^n to R^n.");
+    throw std::invalid_argument("Function output size does not match the number of unknowns.");
+  }
+  res.residual = fx.norm();
+  T stop = opt.tol * std::sqrt(T(n));
+  bool good = opt.update == broyden_update::good;
+
+  std::vector<vector<T>> P, Q;
+  vector<T> d(n), trial(n), s(n), y(n), hy(n);
+  auto apply_h = [&](const vector<T>& w, vector<T>& z) {
+    apply0(w, z);
+    for (size_t j = 0; j < P.size(); ++j) axpby(dot(Q[j], good ? z : w), P[j], T(1.0), z);
+  };
+  auto rebuild = [&]() {
+    refresh(res.x, fx);
+    ++res.jacobian_evaluations;
+    P.clear();
+    Q.clear();
+  };
+
+  rebuild();
+  bool fresh = true;  // H0 was built at the current x and carries no corrections.
+  while (res.iterations < opt.max_iter) {
+    if (res.residual < stop) {
+      res.converged = true;
+      return res;
+    }
+    apply_h(fx, d);
+    d *= T(-1.0);
+
+    T f_old = res.residual, lambda = T(1.0), f_new;
+    for (size_t i = 0; i < n; ++i) trial[i] = res.x[i] + d[i];
+    vector<T> f_trial = f(trial);
+    f_new = f_trial.norm();
+    if (!(f_new <= opt.stall_ratio * f_old)) {
+      // A stalled step from a stale model is not trusted: rebuild H0 at x and recompute the step.
+      if (!fresh) {
+        rebuild();
+        fresh = true;
+        continue;
+      }
+      // With a fresh H0 the direction is a (finite-difference) Newton step, so backtrack along it.
+      for (int ls = 0; !(f_new <= (T(1.0) - T(1e-4) * lambda) * f_old); ++ls) {
+        if (ls == opt.max_backtracks) {
+          Log::Warn("Line search failed in broyden.");
+          return res;
+        }
+        lambda *= T(0.5);
+        for (size_t i = 0; i < n; ++i) trial[i] = res.x[i] + lambda * d[i];
+        f_trial = f(trial);
+        f_new = f_trial.norm();
+      }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      s[i] = trial[i] - res.x[i];
+      y[i] = f_trial[i] - fx[i];
+    }
+    if (opt.memory > 0 && P.size() == opt.memory) {
+      P.clear();
+      Q.clear();
+    }
+    apply_h(y, hy);
+    T denom = good ? dot(s, hy) : dot(y, y);
+    T scale = good ? s.norm() * hy.norm() : T(0.0);
+    if (denom != T(0.0) && std::abs(denom) > std::numeric_limits<T>::epsilon() * scale) {
+      vector<T> p(n);
+      for (size_t i = 0; i < n; ++i) p[i] = (s[i] - hy[i]) / denom;
+      P.push_back(std::move(p));
+      Q.push_back(good ? s : y);
+    }
+    std::swap(res.x, trial);
+    fx = std::move(f_trial);
+    res.residual = f_new;
+    fresh = false;
+    ++res.iterations;
+  }
+  if (res.residual < stop) {
+    res.converged = true;
+    return res;
+  }
+  Log::Warn("Too many iterations in broyden.");
+  return res;
+}
+
+}  // namespace detail
+
+/// @brief Broyden quasi-Newton method for systems F(x) = 0 whose Jacobian is expensive.
+/// The Jacobian is formed by forward differences and LU-factorized only at the start and whenever a step
+/// stalls (||F|| does not drop below opt.stall_ratio of its previous value); in between, the inverse is
+/// corrected by rank-1 secant updates kept in low-rank form on top of the LU factors, at O(n k) per step
+/// instead of n evaluations of F and an O(n^3) factorization. A stalled step with a fresh Jacobian is
+/// backtracked.
+/// @param f The function F: R^n -> R^n.
+/// @param x0 The initial guess.
+/// @param opt Update formula, tolerances and limits (opt.memory bounds the number of stored corrections).
+template <typename T = double, typename F>
+broyden_result<T> broyden(const F& f, const vector<T>& x0, const broyden_options<T>& opt = {}) {
+  linear_algebra::lu_factorization<T> lu;
+  auto refresh = [&](const vector<T>& x, const vector<T>& fx) { lu.factorize(detail::fd_jacobian(f, x, fx)); };
+  auto apply0 = [&](const vector<T>& r, vector<T>& z) { z = lu.solve(r); };
+  return detail::broyden(f, refresh, apply0, x0, opt);
+}
+
+/// @brief Broyden's method with an analytic Jacobian, evaluated only at the start and on stalls.
+/// @param f The function F: R^n -> R^n.
+/// @param jacobian Function returning the n x n Jacobian J_ij = dF_i / dx_j.
+/// @param x0 The initial guess.
+/// @param opt Update formula, tolerances and limits.
+template <typename T = double, typename F, typename Jac>
+  requires std::is_invocable_r_v<tensor<T>, const Jac&, const vector<T>&>
+broyden_result<T> broyden(const F& f, const Jac& jacobian, const vector<T>& x0, const broyden_options<T>& opt = {}) {
+  linear_algebra::lu_factorization<T> lu;
+  auto refresh = [&](const vector<T>& x, const vector<T>&) { lu.factorize(jacobian(x)); };
+  auto apply0 = [&](const vector<T>& r, vector<T>& z) { z = lu.solve(r); };
+  return detail::broyden(f, refresh, apply0, x0, opt);
+}
+
+/// @brief Limited-memory, matrix-free Broyden's method for large systems: H0 = M^-1 is applied by a
+/// preconditioner approximating the Jacobian (e.g. ilu0_preconditioner of the linear part of a discretized
+/// PDE), so only the 2 k correction vectors are stored. A stall discards the corrections and restarts from H0.
+/// Set opt.memory to bound k; with a rough H0 the bad update is often the better choice here.
+/// @param f The function F: R^n -> R^n.
+/// @param x0 The initial guess.
+/// @param M Preconditioner approximating J.
+/// @param opt Update formula, tolerances and limits.
+template <typename T = double, typename F>
+broyden_result<T> broyden(const F& f, const vector<T>& x0, const linear_algebra::preconditioner<T>& M, const broyden_options<T>& opt = {}) {
+  auto refresh = [](const vector<T>&, const vector<T>&) {};
+  auto apply0 = [&](const vector<T>& r, vector<T>& z) { M.apply(r, z); };
+  return detail::broyden(f, refresh, apply0, x0, opt);
+}
+
 /// @brief Evaluates a polynomial and its first and second derivatives at x.
 template <typename T = double>
 std::tuple<T, T, T> eval_poly(const vector<T>& a, T x) {
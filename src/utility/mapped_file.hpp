@@ -0,0 +1,107 @@
+#pragma once
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../inc.hpp"
+#include "log.hpp"
+
+namespace numc {
+namespace utility {
+
+/// @brief Read-only memory mapping of a whole file. The pages are loaded by the OS on first access,
+/// so large inputs can be parsed in place by several threads without copying them into a buffer.
+class mapped_file {
+ private:
+  const char* _data = nullptr;
+  size_t _size = 0;
+#if defined(_WIN32)
+  HANDLE _file = INVALID_HANDLE_VALUE;
+  HANDLE _mapping = nullptr;
+#endif
+
+  [[noreturn]] static void _fail(const std::string& filename) {
+    Log::Error("Failed to map file: " + filename);
+    throw std::runtime_error("Could not open file " + filename);
+  }
+
+  void _close() {
+#if defined(_WIN32)
+    if (_data) UnmapViewOfFile(_data);
+    if (_mapping) CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+    _mapping = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (_data) munmap(const_cast<char*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+  }
+
+ public:
+  /// @brief Maps the file read-only.
+  /// @throws std::runtime_error If the file cannot be opened or mapped.
+  explicit mapped_file(const std::string& filename) {
+#if defined(_WIN32)
+    _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) _fail(filename);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size)) {
+      _close();
+      _fail(filename);
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0) return;
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping) _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+      _close();
+      _fail(filename);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) _fail(filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      _fail(filename);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0) {
+      void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        _size = 0;
+        _fail(filename);
+      }
+      _data = static_cast<const char*>(p);
+      ::madvise(p, _size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);  // the mapping keeps its own reference to the file
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  ~mapped_file() { _close(); }
+
+  /// @brief First byte of the file (nullptr for an empty file).
+  const char* data() const { return _data; }
+
+  /// @brief File size in bytes.
+  size_t size() const { return _size; }
+};
+
+}  // namespace utility
+}  // namespace numc
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "../inc.hpp"
+
+namespace numc {
+namespace utility {
+
+/// @brief Persistent worker pool used by the parallel kernels (SpMV, SpGEMM, blocked factorizations, ...).
+/// Workers are started once and reused, so a parallel region costs a wake-up instead of a thread spawn.
+/// The pool size defaults to std::thread::hardware_concurrency() and can be overridden with the
+/// NUMC_NUM_THREADS environment variable. Nested or concurrent calls fall back to serial execution.
+class thread_pool {
+ private:
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::mutex _job_mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+
+  void (*_invoke)(void*, size_t) = nullptr;
+  void* _ctx = nullptr;
+  size_t _n_tasks = 0;
+  std::atomic<size_t> _next{0};
+  std::atomic<size_t> _remaining{0};
+  std::atomic<bool> _failed{false};
+  std::exception_ptr _error;  // first exception thrown by a task of the current job (guarded by _mutex)
+  size_t _active = 0;
+  size_t _generation = 0;
+  bool _stop = false;
+
+  static bool& _inside_worker() {
+    thread_local bool inside = false;
+    return inside;
+  }
+
+  /// @brief Grabs task indices until the current job is exhausted. A throwing task does not escape: the
+  /// first exception is kept for run() to rethrow, and the tasks not yet started are skipped.
+  void _drain(void (*invoke)(void*, size_t), void* ctx, size_t n_tasks) {
+    for (size_t i = _next.fetch_add(1); i < n_tasks; i = _next.fetch_add(1)) {
+      if (!_failed.load(std::memory_order_relaxed)) {
+        try {
+          invoke(ctx, i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(_mutex);
+          if (!_error) _error = std::current_exception();
+          _failed = true;
+        }
+      }
+      if (_remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done.notify_all();
+      }
+    }
+  }
+
+  void _worker_loop() {
+    _inside_worker() = true;
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      _wake.wait(lock, [&] { return _stop || _generation != seen; });
+      if (_stop) return;
+      seen = _generation;
+      auto invoke = _invoke;
+      void* ctx = _ctx;
+      size_t n_tasks = _n_tasks;
+      ++_active;
+      lock.unlock();
+      _drain(invoke, ctx, n_tasks);
+      lock.lock();
+      if (--_active == 0) _done.notify_all();
+    }
+  }
+
+  thread_pool() {
+    size_t n = std::thread::hardware_concurrency();
+    if (const char* env = std::getenv("NUMC_NUM_THREADS")) {
+      long requested = std::strtol(env, nullptr, 10);
+      if (requested > 0) n = static_cast<size_t>(requested);
+    }
+    if (n == 0) n = 1;
+    _workers.reserve(n - 1);
+    for (size_t i = 0; i + 1 < n; ++i) _workers.emplace_back([this] { _worker_loop(); });
+  }
+
+ public:
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& w : _workers) w.join();
+  }
+
+  /// @brief Returns the process-wide pool.
+  static thread_pool& instance() {
+    static thread_pool pool;
+    return pool;
+  }
+
+  /// @brief Number of threads taking part in a parallel region (workers + calling thread).
+  size_t size() const { return _workers.size() + 1; }
+
+  /// @brief Runs task(i) for every i in [0, n_tasks) and blocks until all of them have finished.
+  /// The calling thread participates in the work. If a task throws, the remaining unstarted tasks are
+  /// skipped and the first exception is rethrown here once every thread has left the job.
+  template <typename F>
+  void run(size_t n_tasks, F&& task) {
+    if (n_tasks == 0) return;
+    std::unique_lock<std::mutex> job_lock(_job_mutex, std::defer_lock);
+    if (n_tasks == 1 || _workers.empty() || _inside_worker() || !job_lock.try_lock()) {
+      for (size_t i = 0; i < n_tasks; ++i) task(i);
+      return;
+    }
+
+    using Fn = std::remove_reference_t<F>;
+    auto invoke = [](void* ctx, size_t i) { (*static_cast<Fn*>(ctx))(i); };
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      // Workers still holding the previous job must let go of it before it is replaced.
+      _done.wait(lock, [&] { return _active == 0; });
+      _invoke = invoke;
+      _ctx = const_cast<void*>(static_cast<const void*>(&task));
+      _n_tasks = n_tasks;
+      _next = 0;
+      _remaining = n_tasks;
+      _failed = false;
+      _error = nullptr;
+      ++_generation;
+    }
+    _wake.notify_all();
+
+    _inside_worker() = true;
+    _drain(invoke, _ctx, n_tasks);
+    _inside_worker() = false;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&] { return _remaining == 0 && _active == 0; });
+    if (_error) std::rethrow_exception(std::exchange(_error, nullptr));
+  }
+};
+
+/// @brief Returns the number of threads available to parallel kernels.
+inline size_t num_threads() { return thread_pool::instance().size(); }
+
+/// @brief Splits [begin, end) into at most num_threads() contiguous chunks of at least `grain`
+/// elements and calls body(lo, hi) for each chunk in parallel.
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+  if (end <= begin) return;
+  size_t n = end - begin;
+  size_t chunks = std::min(num_threads(), std::max<size_t>(1, n / std::max<size_t>(grain, 1)));
+  if (chunks <= 1) {
+    body(begin, end);
+    return;
+  }
+  thread_pool::instance().run(chunks, [&](size_t c) {
+    size_t lo = begin + n * c / chunks;
+    size_t hi = begin + n * (c + 1) / chunks;
+    body(lo, hi);
+  });
+}
+
+/// @brief Splits the items [0, n) into `parts` contiguous ranges of roughly equal cost and returns the
+/// first item of range p. prefix (size n + 1) holds the cumulative weight of the items; every item also
+/// costs one unit on its own, so long runs of empty items are spread out too.
+inline size_t weighted_split(const std::vector<size_t>& prefix, size_t p, size_t parts) {
+  size_t n = prefix.size() - 1;
+  if (p >= parts) return n;
+  size_t target = (prefix[n] - prefix[0] + n) * p / parts;
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (prefix[mid] - prefix[0] + mid < target) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/// @brief Upper bound on the number of chunks of a parallel_reduce, so the partial sums fit on the stack.
+inline constexpr size_t max_reduce_chunks = 64;
+
+/// @brief Parallel sum over [begin, end): body(lo, hi) returns the partial result of a chunk.
+/// Partial sums are kept in a stack buffer and combined in chunk order, so the reduction does not
+/// allocate and the result does not depend on scheduling.
+template <typename T, typename F>
+T parallel_reduce(size_t begin, size_t end, size_t grain, F&& body) {
+  if (end <= begin) return T(0.0);
+  size_t n = end - begin;
+  size_t chunks = std::min({num_threads(), max_reduce_chunks, std::max<size_t>(1, n / std::max<size_t>(grain, 1))});
+  if (chunks <= 1) return body(begin, end);
+  std::array<T, max_reduce_chunks> partial;
+  thread_pool::instance().run(chunks, [&](size_t c) {
+    partial[c] = body(begin + n * c / chunks, begin + n * (c + 1) / chunks);
+  });
+  T sum = T(0.0);
+  for (size_t c = 0; c < chunks; ++c) sum += partial[c];
+  return sum;
+}
+
+}  // namespace utility
+}  // namespace numc